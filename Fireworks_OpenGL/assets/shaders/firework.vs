@@ -1,22 +1,41 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec4 aColor;
-layout (location = 2) in float aSize;
+layout (location = 1) in vec4 aColorSize; // RGBA8 归一化：rgb 为平方根编码的颜色，a 为对数编码的尺寸
+layout (location = 2) in vec2 aAgeRamp;   // x: 归一化年龄 × 65535，y: 颜色渐变下标
+
+// 与 PackedParticleVertex 中的编码常量一致
+const float COLOR_RANGE = 2.0;
+const uint SIZE_BITS_MIN = 0x3C000000u;
+const uint SIZE_BITS_STEP = 262144u;
 
 out vec4 particleColor;
 
 uniform mat4 view;
 uniform mat4 projection;
+uniform float pointScale; // 渲染分辨率比例：降低分辨率时点的像素尺寸同比缩小
+uniform sampler2D colorRamp; // 颜色渐变表：每行一条渐变，横向为归一化年龄（0 = 出生，1 = 死亡）
+
+// 按归一化年龄查颜色渐变：rgb 为颜色倍数，a 为先向白色混合的比例（与 ColorRamp 的定义一致）
+vec3 rampColor(vec3 baseColor, float age, float ramp)
+{
+    vec2 size = vec2(textureSize(colorRamp, 0));
+    vec2 uv = vec2((clamp(age, 0.0, 1.0) * (size.x - 1.0) + 0.5) / size.x, (ramp + 0.5) / size.y);
+    vec4 r = textureLod(colorRamp, uv, 0.0);
+    return mix(baseColor, vec3(1.0), r.a) * r.rgb;
+}
 
 void main()
 {
     vec4 viewPos = view * vec4(aPos, 1.0);
     gl_Position = projection * viewPos;
-    particleColor = aColor;
+    vec3 baseColor = aColorSize.rgb * aColorSize.rgb * COLOR_RANGE;
+    particleColor = vec4(rampColor(baseColor, aAgeRamp.x / 65535.0, aAgeRamp.y), 1.0);
+    uint sizeCode = uint(aColorSize.a * 255.0 + 0.5);
+    float aSize = uintBitsToFloat(SIZE_BITS_MIN + sizeCode * SIZE_BITS_STEP);
     
     // 粒子大小基于距离：靠近时变大（透视效果）
     // 使用viewPos.z的绝对值作为距离
     float distance = length(viewPos.xyz);
     float sizeScale = 200.0 / max(distance, 1.0); // 距离越近，比例越大
-    gl_PointSize = max(1.0, aSize * sizeScale);
+    gl_PointSize = max(1.0, aSize * sizeScale * pointScale);
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+#version 330 core
+// 解析爆炸粒子：粒子只在生成时上传一次，位置、颜色渐变和尺寸全部由当前时间按闭式解算出
+// 运动模型与 CPU 模拟一致：恒定重力 + 指数空气阻力，螺旋烟花的水平速度方向匀速旋转
+layout (location = 0) in vec4 aOriginBirth;  // xyz: 爆炸中心，w: 出生时间
+layout (location = 1) in vec4 aVelLife;      // xyz: 初速度，w: 寿命
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aParams;       // x: 尺寸，y: 初始旋转角度，z: 旋转角速度（0=不旋转），w: 颜色渐变下标
+
+out vec4 particleColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float pointScale; // 渲染分辨率比例：降低分辨率时点的像素尺寸同比缩小
+uniform float time;       // 当前模拟时间（与出生时间同一基准）
+uniform float gravity;
+uniform float dragRate;   // 空气阻力衰减率 k：速度按 e^(-k t) 衰减
+uniform sampler2D colorRamp; // 颜色渐变表：每行一条渐变，横向为归一化年龄（0 = 出生，1 = 死亡）
+
+// 按归一化年龄查颜色渐变：rgb 为颜色倍数，a 为先向白色混合的比例（与 ColorRamp 的定义一致）
+vec3 rampColor(vec3 baseColor, float age, float ramp)
+{
+    vec2 size = vec2(textureSize(colorRamp, 0));
+    vec2 uv = vec2((clamp(age, 0.0, 1.0) * (size.x - 1.0) + 0.5) / size.x, (ramp + 0.5) / size.y);
+    vec4 r = textureLod(colorRamp, uv, 0.0);
+    return mix(baseColor, vec3(1.0), r.a) * r.rgb;
+}
+
+void cull()
+{
+    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    gl_PointSize = 1.0;
+    particleColor = vec4(0.0);
+}
+
+// ∫0^t e^(-k s) ds，k 趋近 0 时取极限 t
+float decayIntegral(float k, float t)
+{
+    return k > 1e-5 ? (1.0 - exp(-k * t)) / k : t;
+}
+
+void main()
+{
+    float t = time - aOriginBirth.w;
+    float life = aVelLife.w - t;
+    if (t < 0.0 || life <= 0.0) {
+        cull();
+        return;
+    }
+
+    float k = dragRate;
+    float decay = decayIntegral(k, t);
+    vec3 v0 = aVelLife.xyz;
+    vec3 offset;
+
+    // 竖直方向：v' = g - k v  =>  y(t) = (g / k) t + (v0 - g / k) ∫e^(-k s) ds
+    offset.y = k > 1e-5 ? (gravity / k) * t + (v0.y - gravity / k) * decay
+                        : v0.y * t + 0.5 * gravity * t * t;
+
+    if (aParams.z != 0.0) {
+        // 螺旋：水平速度 = r0 e^(-k s) (cos θ(s), sin θ(s))，θ(s) = θ0 + ω s
+        // 位移 = r0 Re/Im[ e^(iθ0) (e^((iω - k) t) - 1) / (iω - k) ]
+        float r0 = length(v0.xz);
+        float w = aParams.z;
+        vec2 z = vec2(-k, w);
+        vec2 ezt = exp(-k * t) * vec2(cos(w * t), sin(w * t));
+        vec2 num = ezt - vec2(1.0, 0.0);
+        vec2 q = vec2(num.x * z.x + num.y * z.y, num.y * z.x - num.x * z.y) / dot(z, z);
+        vec2 e0 = vec2(cos(aParams.y), sin(aParams.y));
+        offset.x = r0 * (e0.x * q.x - e0.y * q.y);
+        offset.z = r0 * (e0.x * q.y + e0.y * q.x);
+    }
+    else {
+        offset.xz = v0.xz * decay;
+    }
+
+    vec3 position = aOriginBirth.xyz + offset;
+    if (position.y < 0.0) { // 落到地面以下
+        cull();
+        return;
+    }
+
+    vec4 viewPos = view * vec4(position, 1.0);
+    gl_Position = projection * viewPos;
+
+    particleColor = vec4(rampColor(aColor.rgb, t / aVelLife.w, aParams.w), 1.0);
+
+    float distance = length(viewPos.xyz);
+    float sizeScale = 200.0 / max(distance, 1.0);
+    gl_PointSize = max(1.0, aParams.x * sizeScale * pointScale);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+in vec4 particleColor;
+in vec2 quadCoord;
+
+out vec4 FragColor;
+
+void main()
+{
+    // 与 firework.fs 相同的圆形柔边；拉长的四边形中它变成沿运动方向的椭圆
+    float dist = length(quadCoord) * 0.5;
+
+    if (dist > 0.5) {
+        discard;
+    }
+
+    float alpha = 1.0 - smoothstep(0.3, 0.5, dist);
+
+    FragColor = vec4(particleColor.rgb, particleColor.a * alpha);
+}
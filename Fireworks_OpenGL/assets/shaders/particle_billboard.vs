@@ -0,0 +1,72 @@
+#version 330 core
+// 实例化四边形粒子：每个实例一个粒子，四个角由 aCorner 给出（-1 ~ 1）
+// 尺寸在屏幕像素内夹紧（不依赖驱动的 GL_POINT_SIZE_RANGE），并沿屏幕上的运动方向拉长成火花
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec3 aPos;
+layout (location = 2) in vec4 aColorSize; // 编码与 firework.vs 相同
+layout (location = 3) in vec3 aMotion;    // 最近一个模拟步的位移（世界坐标）
+layout (location = 4) in vec2 aAgeRamp;   // x: 归一化年龄 × 65535，y: 颜色渐变下标
+
+// 与 PackedParticleVertex 中的编码常量一致
+const float COLOR_RANGE = 2.0;
+const uint SIZE_BITS_MIN = 0x3C000000u;
+const uint SIZE_BITS_STEP = 262144u;
+
+out vec4 particleColor;
+out vec2 quadCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float pointScale;    // 渲染分辨率比例：降低分辨率时像素尺寸同比缩小
+uniform vec2 viewportSize;   // 当前视口大小（像素）
+uniform float minPixelSize;  // 粒子直径的像素下限 / 上限（按 pointScale 缩放）
+uniform float maxPixelSize;
+uniform float stretch;       // 拉长系数：拖影长度 = 最近 stretch 步的屏幕位移
+uniform float maxStretchPixels;
+uniform sampler2D colorRamp; // 颜色渐变表：每行一条渐变，横向为归一化年龄（0 = 出生，1 = 死亡）
+
+// 按归一化年龄查颜色渐变：rgb 为颜色倍数，a 为先向白色混合的比例（与 ColorRamp 的定义一致）
+vec3 rampColor(vec3 baseColor, float age, float ramp)
+{
+    vec2 size = vec2(textureSize(colorRamp, 0));
+    vec2 uv = vec2((clamp(age, 0.0, 1.0) * (size.x - 1.0) + 0.5) / size.x, (ramp + 0.5) / size.y);
+    vec4 r = textureLod(colorRamp, uv, 0.0);
+    return mix(baseColor, vec3(1.0), r.a) * r.rgb;
+}
+
+void main()
+{
+    vec3 baseColor = aColorSize.rgb * aColorSize.rgb * COLOR_RANGE;
+    particleColor = vec4(rampColor(baseColor, aAgeRamp.x / 65535.0, aAgeRamp.y), 1.0);
+    uint sizeCode = uint(aColorSize.a * 255.0 + 0.5);
+    float aSize = uintBitsToFloat(SIZE_BITS_MIN + sizeCode * SIZE_BITS_STEP);
+
+    vec4 viewPos = view * vec4(aPos, 1.0);
+    vec4 clipPos = projection * viewPos;
+
+    // 与点精灵相同的距离缩放，再夹紧到像素范围
+    float distance = length(viewPos.xyz);
+    float pixelSize = clamp(aSize * 200.0 / max(distance, 1.0) * pointScale,
+        minPixelSize * pointScale, maxPixelSize * pointScale);
+
+    // 屏幕上的运动方向和长度（上一位置在相机后方时不拉长）
+    vec2 axis = vec2(1.0, 0.0);
+    float streak = 0.0;
+    vec4 clipPrev = projection * view * vec4(aPos - aMotion * stretch, 1.0);
+    if (stretch > 0.0 && clipPos.w > 0.0 && clipPrev.w > 0.0) {
+        vec2 delta = (clipPos.xy / clipPos.w - clipPrev.xy / clipPrev.w) * 0.5 * viewportSize;
+        float len = length(delta);
+        if (len > 0.5) {
+            axis = delta / len;
+            streak = min(len, maxStretchPixels * pointScale);
+        }
+    }
+    vec2 side = vec2(-axis.y, axis.x);
+
+    // 粒子头部保持在当前位置，拖影向运动的反方向延伸
+    vec2 offset = axis * (aCorner.x * 0.5 * (pixelSize + streak) - 0.5 * streak)
+                + side * (aCorner.y * 0.5 * pixelSize);
+    clipPos.xy += offset * 2.0 / viewportSize * clipPos.w;
+    gl_Position = clipPos;
+    quadCoord = aCorner;
+}
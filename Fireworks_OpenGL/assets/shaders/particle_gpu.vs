@@ -0,0 +1,42 @@
+#version 330 core
+// 绘制 GPU 模拟的粒子：直接读取变换反馈缓冲，颜色渐变与 CPU 路径相同（按年龄查颜色渐变表）
+layout (location = 0) in vec4 aPosLife;
+layout (location = 1) in vec4 aVelMaxLife;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aParams;      // x: 尺寸，w: 颜色渐变下标
+
+out vec4 particleColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float pointScale; // 渲染分辨率比例：降低分辨率时点的像素尺寸同比缩小
+uniform sampler2D colorRamp; // 颜色渐变表：每行一条渐变，横向为归一化年龄（0 = 出生，1 = 死亡）
+
+// 按归一化年龄查颜色渐变：rgb 为颜色倍数，a 为先向白色混合的比例（与 ColorRamp 的定义一致）
+vec3 rampColor(vec3 baseColor, float age, float ramp)
+{
+    vec2 size = vec2(textureSize(colorRamp, 0));
+    vec2 uv = vec2((clamp(age, 0.0, 1.0) * (size.x - 1.0) + 0.5) / size.x, (ramp + 0.5) / size.y);
+    vec4 r = textureLod(colorRamp, uv, 0.0);
+    return mix(baseColor, vec3(1.0), r.a) * r.rgb;
+}
+
+void main()
+{
+    // 死亡粒子移到裁剪空间之外，不产生片段
+    if (aPosLife.w <= 0.0) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 1.0;
+        particleColor = vec4(0.0);
+        return;
+    }
+
+    vec4 viewPos = view * vec4(aPosLife.xyz, 1.0);
+    gl_Position = projection * viewPos;
+
+    particleColor = vec4(rampColor(aColor.rgb, 1.0 - aPosLife.w / aVelMaxLife.w, aParams.w), 1.0);
+
+    float distance = length(viewPos.xyz);
+    float sizeScale = 200.0 / max(distance, 1.0);
+    gl_PointSize = max(1.0, aParams.x * sizeScale * pointScale);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+in vec4 particleColor;
+in float across;
+
+out vec4 FragColor;
+
+void main()
+{
+    // 宽度方向的柔边：中心最亮，两侧渐隐
+    float alpha = 1.0 - smoothstep(0.4, 1.0, abs(across));
+    FragColor = particleColor * alpha;
+}
@@ -0,0 +1,75 @@
+#version 330 core
+// 带状拖尾：每个实例是拖尾的一段，四个角由 aCorner 给出（x: -1 = 起点，1 = 终点；y: 宽度方向）
+// 两端分别投影到屏幕，沿段的垂直方向展开；宽度与粒子的像素尺寸相同，向拖尾末端收窄到 0，颜色同时淡出
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec3 aFrom;
+layout (location = 2) in vec3 aTo;
+layout (location = 3) in vec4 aColorSize; // 编码与 firework.vs 相同
+layout (location = 4) in vec4 aParams;    // x: 归一化年龄，y: 颜色渐变下标 / 255，z / w: 起点 / 终点在拖尾上的位置
+
+// 与 PackedParticleVertex 中的编码常量一致
+const float COLOR_RANGE = 2.0;
+const uint SIZE_BITS_MIN = 0x3C000000u;
+const uint SIZE_BITS_STEP = 262144u;
+
+out vec4 particleColor;
+out float across;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float pointScale;    // 渲染分辨率比例：降低分辨率时像素尺寸同比缩小
+uniform vec2 viewportSize;   // 当前视口大小（像素）
+uniform float minPixelSize;  // 拖尾头部宽度的像素下限 / 上限（按 pointScale 缩放）
+uniform float maxPixelSize;
+uniform float tailAlpha;     // 拖尾头部的透明度系数
+uniform sampler2D colorRamp; // 颜色渐变表：每行一条渐变，横向为归一化年龄（0 = 出生，1 = 死亡）
+
+// 按归一化年龄查颜色渐变：rgb 为颜色倍数，a 为先向白色混合的比例（与 ColorRamp 的定义一致）
+vec3 rampColor(vec3 baseColor, float age, float ramp)
+{
+    vec2 size = vec2(textureSize(colorRamp, 0));
+    vec2 uv = vec2((clamp(age, 0.0, 1.0) * (size.x - 1.0) + 0.5) / size.x, (ramp + 0.5) / size.y);
+    vec4 r = textureLod(colorRamp, uv, 0.0);
+    return mix(baseColor, vec3(1.0), r.a) * r.rgb;
+}
+
+void main()
+{
+    float end = aCorner.x * 0.5 + 0.5;
+    vec3 worldPos = mix(aFrom, aTo, end);
+    float t = mix(aParams.z, aParams.w, end);
+
+    vec4 viewPos = view * vec4(worldPos, 1.0);
+    vec4 clipPos = projection * viewPos;
+    vec4 clipFrom = projection * view * vec4(aFrom, 1.0);
+    vec4 clipTo = projection * view * vec4(aTo, 1.0);
+
+    // 任一端在相机后方时整段丢弃（段很短，不做裁剪）
+    if (clipFrom.w <= 0.0 || clipTo.w <= 0.0) {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        particleColor = vec4(0.0);
+        across = 0.0;
+        return;
+    }
+
+    vec2 delta = (clipTo.xy / clipTo.w - clipFrom.xy / clipFrom.w) * 0.5 * viewportSize;
+    float len = length(delta);
+    vec2 axis = len > 1e-3 ? delta / len : vec2(1.0, 0.0);
+    vec2 side = vec2(-axis.y, axis.x);
+
+    uint sizeCode = uint(aColorSize.a * 255.0 + 0.5);
+    float aSize = uintBitsToFloat(SIZE_BITS_MIN + sizeCode * SIZE_BITS_STEP);
+    float distance = length(viewPos.xyz);
+    float pixelSize = clamp(aSize * 200.0 / max(distance, 1.0) * pointScale,
+        minPixelSize * pointScale, maxPixelSize * pointScale);
+    float fade = 1.0 - t;
+
+    clipPos.xy += side * (aCorner.y * 0.5 * pixelSize * fade) * 2.0 / viewportSize * clipPos.w;
+    gl_Position = clipPos;
+
+    // 预乘 alpha：与粒子相同的 GL_ONE / GL_ONE_MINUS_SRC_ALPHA 混合
+    vec3 baseColor = aColorSize.rgb * aColorSize.rgb * COLOR_RANGE;
+    float alpha = tailAlpha * fade;
+    particleColor = vec4(rampColor(baseColor, aParams.x, aParams.y * 255.0) * alpha, alpha);
+    across = aCorner.y;
+}
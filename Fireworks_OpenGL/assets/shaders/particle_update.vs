@@ -0,0 +1,47 @@
+#version 330 core
+// GPU 粒子模拟：每个顶点是一个粒子，结果通过变换反馈写入另一块缓冲
+layout (location = 0) in vec4 inPosLife;     // xyz: 位置，w: 剩余寿命
+layout (location = 1) in vec4 inVelMaxLife;  // xyz: 速度，w: 最大寿命
+layout (location = 2) in vec4 inColor;
+layout (location = 3) in vec4 inParams;      // x: 尺寸，y: 旋转角度，z: 旋转角速度，w: 颜色渐变下标（原样传递）
+
+out vec4 outPosLife;
+out vec4 outVelMaxLife;
+out vec4 outColor;
+out vec4 outParams;
+
+uniform float dt;
+uniform float gravity;
+uniform float drag;
+
+void main()
+{
+    outPosLife = inPosLife;
+    outVelMaxLife = inVelMaxLife;
+    outColor = inColor;
+    outParams = inParams;
+
+    // 已死亡的粒子原样保留，等待被新粒子覆盖
+    if (inPosLife.w <= 0.0) return;
+
+    vec3 vel = inVelMaxLife.xyz;
+
+    // 螺旋烟花旋转
+    if (inParams.z != 0.0) {
+        float angle = inParams.y + dt * inParams.z;
+        float radius = length(vel.xz);
+        vel.x = radius * cos(angle);
+        vel.z = radius * sin(angle);
+        outParams.y = angle;
+    }
+
+    vec3 pos = inPosLife.xyz + vel * dt;
+    vel.y += gravity * dt;
+    vel *= drag; // 空气阻力
+
+    float life = inPosLife.w - dt;
+    if (life <= 0.0 || pos.y < 0.0) life = 0.0;
+
+    outPosLife = vec4(pos, life);
+    outVelMaxLife = vec4(vel, inVelMaxLife.w);
+}
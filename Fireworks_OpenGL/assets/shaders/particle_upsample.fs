@@ -0,0 +1,48 @@
+#version 330 core
+// 低分辨率粒子缓冲的深度感知上采样：
+// 周围 4 个低分辨率像素的深度与本像素的场景深度接近时用双线性采样（平坦区域平滑），
+// 否则（物体边缘）取深度最接近的那个像素，避免粒子颜色越过遮挡边缘渗出
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D particles;      // 粒子颜色（预乘 alpha）
+uniform sampler2D particleDepth;  // 缩小的场景深度
+uniform sampler2D sceneDepth;     // 全分辨率场景深度
+uniform vec2 depthRange;          // 相机近 / 远裁剪面
+
+const float depthThreshold = 0.1; // 相对深度差超过这个比例视为边缘
+
+float linearDepth(float d)
+{
+    float z = d * 2.0 - 1.0;
+    return 2.0 * depthRange.x * depthRange.y / (depthRange.y + depthRange.x - z * (depthRange.y - depthRange.x));
+}
+
+void main()
+{
+    ivec2 lowSize = textureSize(particles, 0);
+    float d = linearDepth(texture(sceneDepth, TexCoords).r);
+
+    // 双线性采样所用的 4 个低分辨率像素
+    vec2 lowPos = TexCoords * vec2(lowSize) - 0.5;
+    ivec2 base = ivec2(floor(lowPos));
+    ivec2 taps[4] = ivec2[4](base, base + ivec2(1, 0), base + ivec2(0, 1), base + ivec2(1, 1));
+
+    float maxDiff = 0.0;
+    float bestDiff = 1e30;
+    ivec2 best = base;
+    for (int i = 0; i < 4; ++i) {
+        ivec2 p = clamp(taps[i], ivec2(0), lowSize - 1);
+        float diff = abs(linearDepth(texelFetch(particleDepth, p, 0).r) - d);
+        maxDiff = max(maxDiff, diff);
+        if (diff < bestDiff) {
+            bestDiff = diff;
+            best = p;
+        }
+    }
+
+    if (maxDiff < depthThreshold * d)
+        FragColor = texture(particles, TexCoords);
+    else
+        FragColor = texelFetch(particles, best, 0);
+}
@@ -0,0 +1,97 @@
+﻿// SimBench - 烟花模拟的无窗口基准（只链接 FireworksSim，不依赖 OpenGL / GLFW / miniaudio）
+// 固定种子的同一场景分别用 标量单线程、向量单线程、向量多线程 三种配置模拟，
+// 报告每帧的模拟耗时和粒子数峰值；三种配置的结果必须逐位一致（内核逐位一致、多线程按块拆分），
+// 不一致时返回 1。用法：FireworksBench [帧数]，需从项目目录运行以加载 assets/shells/show.shells
+#include "FireworkSimulation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct BenchResult {
+    double msPerFrame = 0.0;
+    size_t peakParticles = 0;
+    double checksum = 0.0;
+};
+
+// 本帧所有存活粒子的位置和寿命之和（用于比较各配置的结果）
+static double checksum(const FireworkSimulation& sim) {
+    double sum = 0.0;
+    const ParticleStore& L = sim.launchers();
+    for (size_t i = 0; i < L.count(); ++i) sum += L.posX[i] + L.posY[i] * 3.0 + L.posZ[i] * 7.0 + L.life[i];
+    for (const ParticleChunk* c : sim.explosions().active) {
+        for (int i = 0; i < c->count; ++i) {
+            if (c->life[i] > 0.0f) sum += c->posX[i] + c->posY[i] * 3.0 + c->posZ[i] * 7.0 + c->life[i];
+        }
+    }
+    return sum;
+}
+
+static BenchResult run(int frames, ParticleKernels::Level level, bool multithreaded) {
+    FireworkSimulation sim;
+    sim.setSeed(20240101);
+    sim.simdLevel = level;
+    sim.multithreadedUpdate = multithreaded;
+    sim.loadShells("assets/shells/show.shells");
+
+    // 固定场景：每 20 帧齐射 4 发，依次轮换内置和描述文件中的烟花（包括子发射烟花）
+    static const char* shells[] = { "sphere", "ring", "multilayer", "spiral", "heart", "peony_ring",
+        "triple_burst", "spinning_ring", "gold_willow", "crossette", "kamuro", "chrysanthemum_palm" };
+    const int shellCount = static_cast<int>(sizeof(shells) / sizeof(shells[0]));
+    const float frameTime = 1.0f / 60.0f;
+
+    BenchResult result;
+    double seconds = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        if (frame % 20 == 0) {
+            for (int k = 0; k < 4; ++k) {
+                glm::vec3 position(-6.0f + 4.0f * k, 0.5f, -2.0f);
+                glm::vec4 primary = HSVtoRGB(static_cast<float>((frame / 20 + k) % 12) / 12.0f, 0.8f, 1.0f);
+                sim.launchShell(position, shells[(frame / 20 + k) % shellCount], 1.5f, primary, glm::vec4(1.0f, 0.85f, 0.4f, 1.0f), 0.21f);
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        sim.update(frameTime);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (sim.particleCount() > result.peakParticles) result.peakParticles = sim.particleCount();
+    }
+    result.msPerFrame = seconds * 1000.0 / frames;
+    result.checksum = checksum(sim);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 1800;
+    if (frames <= 0) frames = 1800;
+
+    const ParticleKernels::Level best = ParticleKernels::bestLevel();
+    struct Config {
+        const char* name;
+        ParticleKernels::Level level;
+        bool multithreaded;
+    };
+    const Config configs[] = {
+        { "Scalar, 1 thread", ParticleKernels::Level::Scalar, false },
+        { "SIMD, 1 thread", best, false },
+        { "SIMD, thread pool", best, true },
+    };
+
+    std::printf("[Bench] %d frames, SIMD level %s\n", frames, ParticleKernels::levelName(best));
+    BenchResult baseline;
+    bool identical = true;
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); ++i) {
+        BenchResult r = run(frames, configs[i].level, configs[i].multithreaded);
+        if (i == 0) baseline = r;
+        bool same = std::memcmp(&r.checksum, &baseline.checksum, sizeof(double)) == 0;
+        identical = identical && same;
+        std::printf("[Bench] %-18s %8.3f ms/frame  x%.2f  peak %zu particles  checksum %.6f%s\n", configs[i].name,
+            r.msPerFrame, r.msPerFrame > 0.0 ? baseline.msPerFrame / r.msPerFrame : 0.0, r.peakParticles, r.checksum,
+            same ? "" : "  (MISMATCH)");
+    }
+
+    if (!identical) {
+        std::printf("[Bench] Results differ between configurations\n");
+        return 1;
+    }
+    return 0;
+}
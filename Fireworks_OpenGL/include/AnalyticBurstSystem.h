@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <vector>
+#include "Shader.h"
+
+// AnalyticBurstSystem - 解析（无状态）爆炸粒子
+// 爆炸粒子的运动有闭式解（恒定重力、指数空气阻力、固定寿命和颜色曲线），因此每个粒子只在生成时
+// 上传一次初始状态，之后由顶点着色器按当前时间直接算出位置、淡出和尺寸：
+// CPU 不再逐帧更新或上传这些粒子，GPU 也不需要变换反馈的模拟步。
+// 缓冲按环形使用：写满后新粒子覆盖最早的槽位；已死亡的粒子由着色器跳过。
+class AnalyticBurstSystem {
+public:
+    // 显存中的粒子布局（4 个 vec4，与 particle_analytic.vs 的输入一一对应）
+    struct Particle {
+        glm::vec4 originBirth; // xyz: 爆炸中心，w: 出生时间（相对于缓冲的时间基准）
+        glm::vec4 velLife;     // xyz: 初速度，w: 寿命
+        glm::vec4 color;       // 基础颜色
+        glm::vec4 params;      // x: 尺寸，y: 初始旋转角度，z: 旋转角速度（0=不旋转），w: 颜色渐变下标
+    };
+
+    explicit AnalyticBurstSystem(size_t capacity = 1 << 20);
+    ~AnalyticBurstSystem();
+
+    AnalyticBurstSystem(const AnalyticBurstSystem&) = delete;
+    AnalyticBurstSystem& operator=(const AnalyticBurstSystem&) = delete;
+
+    // 追加一个在模拟时间 birthTime 出生的粒子（在下一次 render 时随批次一起上传）
+    void spawn(const glm::vec3& origin, const glm::vec3& velocity, float life, const glm::vec4& color,
+        float size, float angle, float spin, float ramp, double birthTime);
+
+    // 上传待加入的粒子并绘制模拟时间 time 时的状态（混合、深度写入等渲染状态和纹理单元 0 上的颜色渐变表由调用方设置）
+    // dragRate 为速度的指数衰减率（每单位模拟时间），pointScale 为点尺寸比例
+    void render(const glm::mat4& view, const glm::mat4& projection, double time, float gravity, float dragRate, float pointScale = 1.0f);
+
+    // 清理OpenGL资源
+    void cleanupGL();
+
+    size_t capacity() const { return maxParticles; }
+    size_t activeSlots() const { return usedSlots; } // 需要绘制的槽位数（含已死亡的粒子）
+
+private:
+    void initGL();
+    void uploadPending();
+
+    size_t maxParticles;
+    size_t usedSlots = 0;     // 环形缓冲中已写入过的槽位数
+    size_t head = 0;          // 下一个新粒子写入的槽位
+    double epoch = 0.0;       // 出生时间的基准：缓冲清空后重设，着色器中的时间保持在 float 精度范围内
+    double lastDeath = 0.0;   // 所有已生成粒子中最晚的死亡时间，过了这个时间说明缓冲内全部死亡
+    std::vector<Particle> pending; // 等待上传的新粒子
+
+    GLuint vbo = 0;
+    GLuint vao = 0;
+    Shader* shader = nullptr;
+    bool glInited = false;
+};
@@ -0,0 +1,48 @@
+﻿#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// EventQueue - 按模拟时间排序的延迟事件队列（二叉最小堆）
+// 插入 O(log n)，每步只查看堆顶：等待中的事件不被遍历，成千上万个未到期的事件不产生每步开销。
+// 到期时间相同的事件按插入顺序执行，执行顺序与线程和堆的内部排列无关（结果可复现）
+template <typename T>
+class EventQueue {
+public:
+    // 在模拟时间 time 执行 payload
+    void push(double time, const T& payload) {
+        heap.push_back(Entry{ time, nextSequence++, payload });
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+
+    // 依次取出到期时间 <= now 的事件并调用 fn(payload)；fn 中新加入的已到期事件也在本次执行
+    template <typename Fn>
+    void runDue(double now, Fn fn) {
+        while (!heap.empty() && heap.front().time <= now) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            T payload = heap.back().payload;
+            heap.pop_back();
+            fn(payload);
+        }
+    }
+
+    size_t size() const { return heap.size(); }
+    bool empty() const { return heap.empty(); }
+    void reserve(size_t n) { heap.reserve(n); }
+
+private:
+    struct Entry {
+        double time;
+        uint64_t sequence; // 插入序号（到期时间相同时先进先出）
+        T payload;
+    };
+
+    // std::*_heap 建的是最大堆：“更晚”的事件排在后面，堆顶即最早到期的事件
+    static bool later(const Entry& a, const Entry& b) {
+        if (a.time != b.time) return a.time > b.time;
+        return a.sequence > b.sequence;
+    }
+
+    std::vector<Entry> heap;
+    uint64_t nextSequence = 0;
+};
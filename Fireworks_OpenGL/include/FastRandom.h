@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// FastRandom - xoshiro128+ 伪随机数生成器（16 字节状态，每个数只需几次加法/移位/异或）
+// 种子经 splitmix64 展开，相同种子得到完全相同的序列。
+// 实例之间互不影响：每个爆发、每个模块各持有自己的实例，不跨线程共享，也就不需要加锁
+class FastRandom {
+public:
+    explicit FastRandom(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        uint64_t a = splitMix64(seed);
+        uint64_t b = splitMix64(seed);
+        s[0] = static_cast<uint32_t>(a);
+        s[1] = static_cast<uint32_t>(a >> 32);
+        s[2] = static_cast<uint32_t>(b);
+        s[3] = static_cast<uint32_t>(b >> 32);
+    }
+
+    uint32_t next() {
+        uint32_t result = s[0] + s[3];
+        uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = (s[3] << 11) | (s[3] >> 21);
+        return result;
+    }
+
+    // [0, 1) 均匀分布（取质量较好的高 24 位）
+    float uniform() { return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f); }
+    float uniform(float lo, float hi) { return lo + (hi - lo) * uniform(); }
+
+    // 批量填充 [0, 1) 均匀分布
+    void fill(float* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) out[i] = uniform();
+    }
+
+    // 由演出种子和序号派生子种子：不同序号得到互不相关的随机流
+    static uint64_t deriveSeed(uint64_t seed, uint64_t stream) {
+        uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        return splitMix64(x);
+    }
+
+private:
+    static uint64_t splitMix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t s[4];
+};
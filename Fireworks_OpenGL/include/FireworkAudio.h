@@ -0,0 +1,34 @@
+﻿#pragma once
+#include "FireworkSimulation.h"
+#include "miniaudio.h"
+
+// FireworkAudio - 烟花音效：作为事件接收者挂到模拟上，升空和第一次爆炸时播放音效
+// 事件只计数，flush() 时每种音效最多触发 maxVoicesPerFlush 个声音：
+// 齐射的几十个上升弹听起来和几个差不多，却不会在同一帧同步启动几十个声音
+class FireworkAudio : public FireworkEventSink {
+public:
+    FireworkAudio();
+    ~FireworkAudio();
+
+    FireworkAudio(const FireworkAudio&) = delete;
+    FireworkAudio& operator=(const FireworkAudio&) = delete;
+
+    void onLaunch(const glm::vec3& position, FireworkType type) override;
+    void onExplosion(const glm::vec3& position, FireworkType type, const glm::vec4& color, bool isSecondary) override;
+
+    // 播放上次 flush 以来累积的音效（每帧调用一次）
+    void flush();
+
+    int maxVoicesPerFlush = 3; // 每次 flush 每种音效最多同时触发的声音数
+
+private:
+    void playVariants(const std::string (&variants)[2], int count);
+
+    ma_engine audioEngine;          // miniaudio引擎实例
+    bool audioInitialized = false;  // 音频初始化状态标志
+    FastRandom variantRandom;       // 选择音效变体（与演出种子无关，不影响可复现性）
+    std::string risePaths[2];       // 两个音效变体的文件路径（构造时拼好，播放时不再拼接字符串）
+    std::string explosionPaths[2];
+    int pendingRises = 0;           // 自上次 flush 以来的升空 / 主爆炸次数
+    int pendingExplosions = 0;
+};
@@ -1,32 +1,27 @@
 ﻿#pragma once
 #include <glm/glm.hpp>
 #include <vector>
+#include <memory>
 #include <glad/glad.h>
-#include "miniaudio.h"  // 添加miniaudio音频库支持
+#include "FireworkSimulation.h"
+#include "FireworkAudio.h"
+#include "GpuParticleSystem.h"
+#include "AnalyticBurstSystem.h"
+#include "PackedParticleVertex.h"
+#include "StreamBuffer.h"
 #include "Shader.h"
 #include "PointLight.h"
 
 // FireworkParticleSystem - 烟花粒子系统
 // 支持多种烟花类型、颜色渐变、二次爆炸、拖尾效果及音效
-class FireworkParticleSystem {
+// 模拟逻辑全部在 FireworkSimulation 中；这里负责 OpenGL 绘制、GPU 模拟模式，
+// 并以事件接收者的方式挂上音效（FireworkAudio）和爆炸光源
+class FireworkParticleSystem : public FireworkSimulation, private FireworkEventSink, private ParticleHandOff {
 public:
-    // 支持的烟花类型（所有类型都支持二次爆炸）
-    enum class FireworkType {
-        Sphere,          // 球形烟花
-        Ring,            // 环形烟花
-        MultiLayer,      // 多层烟花
-        Spiral,          // 螺旋烟花
-        Heart,           // 心形烟花
-        Image            // 图片烟花
-    };
-
     FireworkParticleSystem();
     ~FireworkParticleSystem();
 
-    // 发射一个烟花（上升弹）
-    void launch(const glm::vec3& position, FireworkType type, float life, const glm::vec4& primaryColor, const glm::vec4& secondaryColor = glm::vec4(1.0f), float size = 0.05f);
-
-    // 更新粒子系统（每帧调用，deltaTime 单位：秒）
+    // 更新粒子系统（每帧调用，deltaTime 单位：秒）；GPU 模式下同时推进 GPU 粒子
     void update(float deltaTime);
 
     // 渲染粒子（需要先 setViewProj）
@@ -38,90 +33,82 @@ public:
     // 设置光源管理器指针（用于烟花爆炸时添加点光源）
     void setLightManager(PointLightManager* manager);
 
-    // 测试方法：依次发射各种类型烟花
-    void runTest(float currentTime);
+    // 爆炸闪光合并：同一帧内相距不到这个距离的主爆炸只添加一组光源（位置取平均，亮度按数量的平方根增加）
+    float lightMergeDistance = 4.0f;
 
     // 清理OpenGL资源
     void cleanupGL();
 
-    // 拖尾参数
-    float tailLife = 0.06f;        // 拖尾粒子的寿命（秒）- 减少到80%
-    float tailInterval = 0.015f;    // 拖尾生成间隔（秒）
-    float tailAlpha = 0.8f;         // 🔧 拖尾透明度系数（提高至0.8，原本0.5）
+    // GPU 模拟参数：开启后爆炸粒子交给变换反馈模拟（不产生拖尾），上升弹仍在 CPU 上更新
+    bool gpuSimulation = false;
+    size_t gpuParticleCapacity = 1 << 20; // GPU 粒子缓冲容量（第一次开启时生效）
+
+    // 解析爆炸模式：爆炸粒子生成时上传一次，之后由顶点着色器按时间算出位置（不产生拖尾，优先于 gpuSimulation）
+    bool analyticBursts = false;
+    size_t analyticParticleCapacity = 1 << 20; // 解析粒子缓冲容量（第一次开启时生效）
 
-    // 尺寸和物理参数
-    float launcherSize = 0.1f;     // 上升弹粒子大小
-    float childSize = 0.3f;        // 爆炸子粒子大小
-    float gravity = -5.5f;          // 重力加速度（负Y方向）
-    float timeScale = 0.18f;         // 时间缩放（1.0=正常，0.5=慢动作）
+    // 点尺寸比例（场景以较低分辨率渲染时设为同一比例，粒子在屏幕上的大小不变）
+    float pointScale = 1.0f;
+
+    // 实例化四边形路径（替代 GL_POINTS）：尺寸按屏幕像素夹紧，不受驱动点尺寸上限影响，并沿运动方向拉长
+    bool billboards = false;
+    float minPixelSize = 1.0f;       // 粒子直径下限（像素）
+    float maxPixelSize = 48.0f;      // 粒子直径上限（像素）
+    float velocityStretch = 2.0f;    // 拖影长度 = 最近这么多个模拟步的屏幕位移（0 = 不拉长）
+    float maxStretchPixels = 64.0f;  // 拖影长度上限（像素）
 
 private:
-    struct Particle {
-        glm::vec3 position;        // 位置
-        glm::vec3 velocity;        // 速度
-        glm::vec4 color;           // 颜色（RGBA）
-        glm::vec4 initialColor;    // 初始颜色（用于颜色渐变）
-        glm::vec4 secondaryColor; // 第二次爆炸颜色（仅用于dual-color烟花）
-        float life;                // 剩余寿命（秒）
-        float maxLife;             // 最大寿命（用于计算生命周期比例）
-        float size;                // 规格化尺寸（0..1），在顶点着色器中转换为像素大小
-        FireworkType type;         // 烟花类型
-        bool isDualColor = false; // 是否为双色烟花
-        bool isTail = false;       // 是否为拖尾粒子，防止递归产生尾迹
-        bool canExplodeAgain = false; // 是否可以二次爆炸
-        float rotationAngle = 0.0f;   // 旋转角度（用于螺旋烟花）
-        float tailTimer = 0.0f;       // 拖尾生成计时器
-        float explodeAtHeight = 0.0f; // 随机爆炸高度
-        std::string imagePath = "";  // 图片烟花的路径（仅对Image类型有效）
+    // 按绘制路径写入一个 CPU 粒子（点精灵不需要位移，编译后不计算）
+    static void packVertex(PackedParticleVertex& v, const glm::vec3& position, const glm::vec3&, const glm::vec4& color, float size, float age, uint32_t ramp) {
+        v = PackedParticleVertex::pack(position, color, size, age, ramp);
+    }
+    static void packVertex(PackedBillboardVertex& v, const glm::vec3& position, const glm::vec3& motion, const glm::vec4& color, float size, float age, uint32_t ramp) {
+        v = PackedBillboardVertex::pack(position, motion, color, size, age, ramp);
+    }
+
+    // 带状拖尾：每个粒子从当前位置连到记录的历史位置，写入最多 TrailRing::SAMPLES 段，返回段数
+    size_t writeTrails(PackedTrailSegment* out, float alpha) const;
+
+    // 颜色渐变表：烟花描述目录中的渐变烘焙成 RAMP_WIDTH × 渐变数 的纹理，目录修改后重建
+    static const int RAMP_WIDTH = 256;
+    void updateRampTexture();
+
+    // 同一帧内待添加的爆炸闪光（按距离合并）
+    struct LightFlash {
+        glm::vec3 position;
+        glm::vec3 color; // 合并的各闪光颜色之和
+        int count;
     };
+    void flushLights();
 
-    // 图片数据结构
-    struct ImageData {
-        std::vector<glm::vec4> pixels; // 像素颜色数组
-        int width;
-        int height;
-    };
+    // 爆炸时记录闪光，帧末合并后添加点光源
+    void onExplosion(const glm::vec3& position, FireworkType type, const glm::vec4& color, bool isSecondary) override;
 
-    // 延迟爆炸事件结构
-    struct DelayedExplosion {
-        glm::vec3 position;        // 爆炸位置
-        glm::vec4 color;           // 爆炸颜色
-        FireworkType type;         // 烟花类型
-        float timer;               // 倒计时（秒）
-        float radius;              // 爆炸半径
-    };
+    // GPU / 解析模式：接管新生成的爆炸粒子
+    void takeParticles(const ParticleChunk& chunk, float spin) override;
 
-    std::vector<Particle> launcherParticles;   // 上升粒子
-    std::vector<Particle> explosionParticles;  // 爆炸粒子
-    std::vector<Particle> tailParticles;       // 拖尾粒子
-    std::vector<DelayedExplosion> delayedExplosions; // 延迟二次爆炸事件
-    std::vector<Particle> particles;           // 渲染时合并所有粒子的容器
+    FireworkAudio audio;                     // 音效
+    StreamBuffer stream;                     // CPU 粒子的顶点流缓冲（每粒子 20 字节的紧凑顶点）
+    StreamBuffer trailStream;                // 拖尾段的流缓冲（每段 32 字节）
+    std::unique_ptr<GpuParticleSystem> gpuParticles; // GPU 模拟的爆炸粒子（开启 gpuSimulation 后创建）
+    std::unique_ptr<AnalyticBurstSystem> analyticParticles; // 解析爆炸粒子（开启 analyticBursts 后创建）
 
     glm::mat4 viewMatrix;
     glm::mat4 projMatrix;
     Shader* shader = nullptr;
+    Shader* billboardShader = nullptr;
+    Shader* trailShader = nullptr;
     PointLightManager* lightManager = nullptr;
+    std::vector<LightFlash> pendingFlashes;
 
     // OpenGL 对象
     GLuint vao = 0;
-    GLuint vbo = 0;
+    GLuint billboardVao = 0;  // 实例化四边形（角点 + 每实例属性）
+    GLuint trailVao = 0;      // 拖尾段（角点 + 每段两端的属性）
+    GLuint quadVbo = 0;       // 四边形的四个角
+    GLuint rampTexture = 0;   // 颜色渐变表（所有粒子路径共用，绑定在纹理单元 0）
+    uint32_t rampRevision = 0xFFFFFFFFu; // 纹理对应的渐变版本
+    float viewportHeight = 0.0f;         // 最近一次渲染的视口高度（像素，换算拖尾采样的屏幕缩放）
     void initGL();
     bool glInited = false;
-
-    // 音频引擎
-    ma_engine audioEngine;          // miniaudio引擎实例
-    bool audioInitialized = false;  // 音频初始化状态标志
-
-    // 辅助方法
-    void createExplosion(const Particle& source, bool isSecondary = false);
-    glm::vec4 calculateColorGradient(const Particle& p) const;
-    void generateSphereParticles(const glm::vec3& center, const glm::vec4& color, int count, float radius = 4.0f, bool canExplode = false);
-    void generateRingParticles(const glm::vec3& center, const glm::vec4& color, int count, float radiusScale = 3.5f);
-    void generateMultiLayerParticles(const glm::vec3& center, const glm::vec4& color, int count, float radiusScale = 3.0f);
-    void generateSpiralParticles(const glm::vec3& center, const glm::vec4& color, int count, float radiusScale = 4.0f);
-    void generateHeartParticles(const glm::vec3& center, const glm::vec4& color, int count, float radiusScale = 3.0f);
-    void generateImageParticles(const glm::vec3& center, const std::string& imagePath, int sampleRate = 2);
-    
-    // 图片加载辅助方法
-    ImageData loadImage(const std::string& imagePath);
-};
\ No newline at end of file
+};
@@ -0,0 +1,299 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "ParticleStore.h"
+#include "ParticleChunk.h"
+#include "ImageTemplateCache.h"
+#include "JobSystem.h"
+#include "ParticleKernels.h"
+#include "FastRandom.h"
+#include "FireworkType.h"
+#include "ShellCatalog.h"
+#include "Frustum.h"
+#include "EventQueue.h"
+
+// HSV 转 RGB（h/s/v 取值 0~1）
+glm::vec4 HSVtoRGB(float h, float s, float v);
+
+// FireworkEventSink - 模拟事件的接收者
+// 音效、光源等表现层实现这个接口并注册到模拟中，模拟本身不依赖它们
+class FireworkEventSink {
+public:
+    virtual ~FireworkEventSink() = default;
+
+    // 发射上升弹
+    virtual void onLaunch(const glm::vec3& /*position*/, FireworkType /*type*/) {}
+
+    // 爆炸（isSecondary=true 为延迟的第二次爆炸）
+    virtual void onExplosion(const glm::vec3& /*position*/, FireworkType /*type*/, const glm::vec4& /*color*/, bool /*isSecondary*/) {}
+};
+
+// ParticleHandOff - 爆炸粒子的接管者（如 GPU 模拟）
+// 设置后，新生成的爆炸粒子每帧整块交给它，模拟在本帧末回收这些块，不再在 CPU 上积分
+class ParticleHandOff {
+public:
+    virtual ~ParticleHandOff() = default;
+
+    // chunk 中 life > 0 的槽位为存活粒子；spin 为水平速度绕 Y 轴的旋转角速度（0 = 不旋转）
+    virtual void takeParticles(const ParticleChunk& chunk, float spin) = 0;
+};
+
+// FireworkSimulation - 烟花模拟核心
+// 只依赖 glm 和标准库（不依赖 OpenGL / GLFW / miniaudio），可在无窗口、无声卡的测试和基准程序中全速运行
+class FireworkSimulation {
+public:
+    using FireworkType = ::FireworkType;
+
+    FireworkSimulation();
+
+    // 演出种子：每个爆发的随机流都由它和爆发序号派生，相同种子 + 相同操作序列得到完全相同的演出
+    void setSeed(uint64_t seed);
+    uint64_t seed() const { return showSeed; }
+
+    // 发射一个烟花（上升弹），爆炸效果取该类型的内置烟花描述
+    void launch(const glm::vec3& position, FireworkType type, float life, const glm::vec4& primaryColor, const glm::vec4& secondaryColor = glm::vec4(1.0f), float size = 0.05f);
+
+    // 按名称发射烟花描述目录中的烟花；名称不存在时返回 false（imagePath 为图片烟花的图片，空 = 默认图片）
+    bool launchShell(const glm::vec3& position, const std::string& name, float life, const glm::vec4& primaryColor, const glm::vec4& secondaryColor = glm::vec4(1.0f), float size = 0.05f,
+        const std::string& imagePath = "");
+
+    // 批量发射的一条描述：shell 为烟花描述目录中的下标（shellCatalog().find / forType 取得）
+    struct LaunchRequest {
+        glm::vec3 position = glm::vec3(0.0f, 0.5f, 0.0f); // (0, 0.5, 0) = 随机位置
+        uint32_t shell = 0;
+        float life = 1.5f;
+        glm::vec4 primaryColor = glm::vec4(1.0f);
+        glm::vec4 secondaryColor = glm::vec4(1.0f);
+        float size = 0.05f;
+        const std::string* imagePath = nullptr; // 图片烟花的图片（空 = 默认图片；只在调用期间读取）
+    };
+
+    // 一次发射一批烟花（齐射 / 终场）：存储只预留一次；音效、光源等接收者照常逐个收到 onLaunch，
+    // 由它们在帧末合并同一帧的触发；shell 不是有效编号的请求报错后跳过（与 launchShell 的未知名称一致）
+    void launchBatch(const LaunchRequest* requests, size_t count);
+
+    // 加载烟花描述文件（格式见 ShellCatalog.cpp），返回编译的烟花数量；同名描述覆盖内置描述
+    int loadShells(const std::string& path);
+    const ShellCatalog& shellCatalog() const { return shells; }
+
+    // 更新粒子系统（每帧调用，deltaTime 单位：秒）
+    // 内部以固定步长推进：帧时间累积后按 fixedStep 切成若干子步，单帧最多 maxSubSteps 步
+    void update(float deltaTime);
+
+    // 渲染插值系数：距上一个模拟步已过去的时间占一步的比例（0~1）
+    // 渲染位置 = 上一步位置 + (当前位置 - 上一步位置) * alpha
+    float interpolationAlpha() const { return accumulator / fixedStep; }
+
+    // 最近一次 update 实际执行的子步数，以及每一步的模拟时长和空气阻力系数（外部模拟按同样的步长推进）
+    int lastSubSteps() const { return subStepsTaken; }
+    // 正在推进的子步在本次 update 中的序号（从 0 开始，update 在每一步之前设置）；update 之外为 0
+    int currentStepIndex() const { return stepIndex; }
+    float stepDelta() const { return fixedStep * timeScale; }
+    float stepDrag() const;
+
+    // 已模拟的总时长（模拟时间，即各步 stepDelta 之和）；接管者收到粒子时为本步开始的时刻
+    double simulationTime() const { return simTime; }
+
+    // 测试方法：依次发射各种类型烟花
+    void runTest(float currentTime);
+
+    // 在后台线程预解码图片烟花模板（演出开始前调用，避免爆炸时卡顿）
+    void preloadImages(const std::vector<std::string>& imagePaths);
+
+    // 注册事件接收者（不转移所有权，接收者需比模拟活得更久）
+    void addEventSink(FireworkEventSink* sink);
+
+    // 设置爆炸粒子接管者（nullptr = 在 CPU 上模拟）
+    void setHandOff(ParticleHandOff* target);
+
+    // 全局粒子预算：爆炸粒子的总数上限（向上取整到整块），存储按上限一次性预先分配
+    // 超出预算时按优先级（主爆炸 > 二次爆炸）准入：低优先级的粒子被缩减或丢弃，
+    // 必要时回收最老 / 离观察点最远的爆炸粒子块，为高优先级的爆炸腾出空间
+    void setParticleBudget(size_t maxParticles);
+    size_t particleBudget() const { return chunkArena.capacity() * ParticleChunk::CAPACITY; }
+
+    // 观察点（相机位置）：预算紧张时，离观察点越远的爆炸生成的粒子越少、越先被回收
+    void setViewPoint(const glm::vec3& eye);
+
+    // 视锥体（projection * view）：视锥体外的爆炸不上传、不绘制，按 offscreenTickInterval 降频模拟且不产生拖尾
+    void setViewFrustum(const glm::mat4& viewProj);
+
+    // 屏幕缩放：裁剪空间 w = 1 处一个世界单位在屏幕上的像素数（0.5 × 视口高度 × projection[1][1]）。
+    // 设置（> 0）后拖尾按粒子在屏幕上的位移采样，否则按 tailInterval 的固定间隔采样
+    void setScreenScale(float pixelsPerUnit);
+
+    // 爆炸粒子块所属爆发的包围球是否与视锥体相交（未设置视锥体、关闭剔除或不属于任何爆发时返回 true）
+    bool chunkVisible(const ParticleChunk& chunk) const;
+
+    // 粒子块使用的颜色渐变（ShellCatalog::ramp 的下标；不属于爆发的块使用默认渐变 0）
+    uint32_t chunkRamp(const ParticleChunk& chunk) const {
+        return chunk.burst == ParticleChunk::NO_BURST ? 0u : bursts[chunk.burst].ramp;
+    }
+
+    // 只读访问粒子状态（渲染器、测试和基准程序使用）
+    const ParticleStore& launchers() const { return launcherParticles; }
+    const ParticleChunkPool& explosions() const { return explosionChunks; }
+    size_t particleCount() const;
+
+    // 屏幕缩放未知时（无窗口运行、第一次渲染前）的拖尾采样间隔（模拟步数，由 tailInterval 换算）
+    int trailSpacing() const;
+
+    // 相邻两个拖尾采样至少相隔的步数：最新的采样可能刚记录，其余 SAMPLES - 1 个间隔要覆盖 tailLife，
+    // 快的粒子（每步移动超过 tailMinPixels）也按这个间隔采样，拖尾长度不会因采样用完而缩短
+    int trailMinGap() const;
+
+    // 拖尾参数（每个粒子记录最近的几个位置，渲染成带状拖尾）
+    float tailLife = 0.06f;        // 拖尾覆盖的时长（秒，模拟时间）
+    float tailInterval = 0.015f;    // 屏幕缩放未知时的拖尾采样间隔（秒）
+    float tailMinPixels = 2.0f;     // 拖尾采样的屏幕位移阈值：间隔达到 trailMinGap 后，移动不到这么多像素时仍不记录（跳过慢的、远的爆发）
+    float tailAlpha = 0.8f;         // 🔧 拖尾透明度系数（提高至0.8，原本0.5）
+    int tailStride = 1;             // 拖尾密度：每 tailStride 个爆炸粒子中有一个绘制拖尾（质量调节用）
+
+    // 质量参数（由 QualityGovernor 按帧时间调节）
+    float particleScale = 1.0f;     // 每次爆炸的粒子数比例（按比例从形状模板中均匀取点）
+
+    // 粒子预算参数
+    float budgetSoftLimit = 0.75f;   // 预算占用超过这个比例后，按距离缩减远处爆炸的粒子数
+    float relevanceDistance = 25.0f; // 距观察点这个距离以内的爆炸不缩减
+    float minRelevanceScale = 0.25f; // 远处爆炸至少保留的粒子比例
+
+    // 视锥体剔除参数
+    bool frustumCulling = true;      // 是否剔除视锥体外的爆炸
+    int offscreenTickInterval = 3;   // 视锥体外的爆炸每几步积分一次（1 = 不降频）
+
+    // 子发射参数
+    float subEmitWindow = 0.015f;    // 寿命结束触发的子发射按这个间隔（模拟时间）对齐成批：窗口内将熄灭的粒子提前一起爆开
+
+    // 尺寸和物理参数
+    float launcherSize = 0.1f;     // 上升弹粒子大小
+    float childSize = 0.3f;        // 爆炸子粒子大小
+    float gravity = -5.5f;          // 重力加速度（负Y方向）
+    float drag = 0.993f;            // 空气阻力（每 1/60 秒速度保留的比例，按步长换算）
+    float timeScale = 0.18f;         // 时间缩放（1.0=正常，0.5=慢动作）
+
+    // 固定步长参数
+    float fixedStep = 1.0f / 60.0f;  // 模拟步长（秒，真实时间；弱机器可调大以降低模拟频率）
+    int maxSubSteps = 5;             // 单帧最多子步数，超出的帧时间直接丢弃，避免卡顿后越追越慢
+
+    // 多线程更新参数
+    bool multithreadedUpdate = true; // 是否在线程池上并行更新粒子
+    unsigned workerThreads = 0;      // 线程数（0=按硬件线程数，在第一次更新时生效）
+    ParticleKernels::Level simdLevel = ParticleKernels::bestLevel(); // 粒子内核指令集（可强制为 Scalar 对照）
+
+private:
+    // 粒子预算的准入优先级（数值越小越优先）
+    enum class SpawnPriority : uint8_t { Primary, Secondary };
+
+    static const uint32_t NO_EMITTERS = 0xFFFFFFFFu; // 爆发没有发射点列表（单点爆炸）
+
+    // 发射点：一个阶段的粒子从每个发射点按同一形状生成，并继承发射点的速度
+    // （上升弹爆炸是速度为 0 的单点；子发射时每个熄灭的粒子是一个发射点）
+    struct Emitter {
+        glm::vec3 position;
+        glm::vec3 velocity;
+    };
+
+    // 子发射请求：工作线程在积分时记录熄灭粒子的位置、速度和所属爆发，全部块更新完后统一生成
+    struct SubEmit {
+        Emitter emitter;
+        uint32_t burst;
+    };
+
+    // 爆发（burst）：一次发射或一次爆炸产生的一组粒子共享的冷数据，每个爆发只存一份
+    struct Burst {
+        FireworkType type = FireworkType::Sphere; // 烟花类型（通知表现层）
+        uint32_t shell = 0;           // 烟花描述（上升弹爆炸时执行）
+        glm::vec4 primaryColor = glm::vec4(1.0f);   // 主色
+        glm::vec4 secondaryColor = glm::vec4(1.0f); // 第二次爆炸颜色（仅用于dual-color烟花）
+        bool isDualColor = false;     // 是否为双色烟花
+        bool emitsTail = true;        // 是否产生拖尾（图片烟花粒子不产生）
+        uint32_t subShell = ShellCatalog::NOT_FOUND; // 子发射的烟花（粒子熄灭处按它爆开）
+        float subTime = 0.0f;         // 子发射时刻（块年龄，秒；0 = 每个粒子寿命结束时）
+        uint32_t emitters = NO_EMITTERS; // 子烟花的发射点列表（emitterLists 的下标）
+        float spin = 0.0f;            // 水平速度绕 Y 轴的旋转角速度（螺旋烟花）
+        uint16_t ramp = 0;            // 颜色渐变（爆发内所有粒子共用，渲染时按年龄查表）
+        SpawnPriority priority = SpawnPriority::Primary; // 预算准入优先级（主爆炸 / 二次爆炸）
+        glm::vec3 origin = glm::vec3(0.0f); // 爆炸中心（包围球的起点；多个发射点时为它们的中心）
+        float spread = 0.0f;          // 发射点到 origin 的最大距离（单点爆炸为 0）
+        float maxSpeed = 0.0f;        // 粒子的最大初速度（包围球半径随块年龄线性增长）
+        std::string imagePath;        // 图片烟花的路径（仅对Image类型有效）
+        uint32_t refCount = 0;        // 引用该爆发的上升粒子/粒子块数，归零后回收
+    };
+
+    // 延迟爆炸事件：烟花描述中 delay > 0 的阶段（持有来源爆发的一个引用，执行后释放），
+    // 按到期的模拟时间放入 delayedExplosions
+    struct DelayedExplosion {
+        glm::vec3 position;        // 爆炸位置
+        uint32_t burst;            // 来源爆发（颜色、烟花描述、图片路径）
+        uint32_t stage;            // 阶段序号
+    };
+
+    ParticleStore launcherParticles;       // 上升粒子（数量少，逐粒子压缩删除）
+    ParticleChunkArena chunkArena;         // 爆炸粒子块的预分配存储（全局粒子预算）
+    ParticleChunkPool explosionChunks{ chunkArena }; // 爆炸粒子（按爆发分块，整块到期回收）
+    std::vector<Burst> bursts;         // 爆发冷数据（按下标引用）
+    std::vector<uint32_t> freeBursts;  // 已回收、可复用的爆发下标
+    EventQueue<DelayedExplosion> delayedExplosions; // 延迟二次爆炸事件（按到期时间排序，每步只处理到期的）
+    std::vector<size_t> explodeScratch;      // 本帧需要爆炸的上升粒子下标
+    std::vector<std::vector<SubEmit>> subEmitQueues; // 每个更新任务收集的子发射（按任务顺序处理，结果与线程数无关）
+    std::vector<std::vector<Emitter>> emitterLists;  // 子烟花的发射点列表（随爆发回收，容量复用）
+    std::vector<uint32_t> freeEmitterLists;  // 已回收、可复用的发射点列表下标
+    std::vector<std::pair<glm::vec3, uint32_t>> subScratch; // 本步要爆开的子烟花（发射点中心、爆发）
+    std::vector<std::pair<float, ParticleChunk*>> cullScratch; // 预算回收的候选块（按回收顺序排序）
+    glm::vec3 viewPoint = glm::vec3(0.0f);   // 观察点（相机位置）
+    Frustum viewFrustum;                     // 视锥体（剔除和相关性）
+    glm::vec4 clipW = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // 视图投影矩阵的 w 行（估算裁剪空间深度）
+    float screenScale = 0.0f;                // 屏幕缩放（0 = 未知，拖尾按固定间隔采样）
+    bool hasViewPoint = false;               // 是否设置过观察点
+    ImageTemplateCache imageCache;           // 图片烟花模板缓存
+    ShapeTemplates shapes;                   // 预计算的烟花形状模板
+    ShellCatalog shells;                     // 烟花描述目录（编译后的阶段 / 发射指令）
+    std::unique_ptr<JobSystem> jobs;         // 粒子更新线程池（延迟创建）
+    std::vector<FireworkEventSink*> eventSinks; // 事件接收者（音效、光源等）
+    ParticleHandOff* handOff = nullptr;      // 爆炸粒子接管者（nullptr = CPU 模拟）
+    uint64_t showSeed = 0;                   // 演出种子
+    uint64_t burstSerial = 0;                // 已分配的爆发随机流序号
+    FastRandom showRandom;                   // 演出级随机流（发射位置、颜色、测试序列）
+    std::vector<float> randomScratch;        // 批量生成的随机数
+    float accumulator = 0.0f;                // 尚未模拟的帧时间（真实时间，小于一步）
+    int subStepsTaken = 0;                   // 最近一次 update 执行的子步数
+    int stepIndex = 0;                       // 正在推进的子步序号（见 currentStepIndex）
+    double simTime = 0.0;                    // 已模拟的总时长（模拟时间）
+    float testLastTime = 0.0f;               // runTest 上一次发射的时间
+    bool testSkipNext = false;               // runTest 是否跳过下一次发射（图片烟花之后）
+
+    // 辅助方法
+    uint32_t allocBurst(FireworkType type, const glm::vec4& primaryColor, const glm::vec4& secondaryColor = glm::vec4(1.0f));
+    void launchProgram(const glm::vec3& position, uint32_t shell, float life, const glm::vec4& primaryColor,
+        const glm::vec4& secondaryColor, float size, const std::string& imagePath = "");
+    void releaseBurst(uint32_t index);
+    FastRandom burstRandom();
+    const float* randomBatch(FastRandom& rng, size_t count);
+    void spawnParticle(ChunkWriter& writer, const glm::vec3& position, const glm::vec3& velocity,
+        const glm::vec4& color, float life, float size, float angle = 0.0f);
+    void spawnLauncher(const glm::vec3& position, uint32_t shell, float life, const glm::vec4& primaryColor,
+        const glm::vec4& secondaryColor, float size, const std::string& imagePath = "");
+    void warmShapes();
+    void createExplosion(const glm::vec3& position, uint32_t sourceBurst);
+    void runStage(const glm::vec3& position, uint32_t sourceBurst, uint32_t stage);
+    void executeSpawnOp(const SpawnOp& op, const Emitter* emitters, size_t emitterCount, const Burst& source, SpawnPriority priority);
+    void executeImageOp(const SpawnOp& op, const glm::vec3& center, const Burst& source, SpawnPriority priority);
+    int admitParticles(int count, SpawnPriority priority, const glm::vec3& center);
+    void makeRoom(size_t needed, SpawnPriority priority);
+    float relevance(const glm::vec3& position) const;
+    static glm::vec4 stageColor(ShellColor color, const Burst& source);
+    void step(float dt, float dragFactor);
+    void updateExplosionChunks(float dt, float dragFactor, int trailSpacing, int trailMinGap);
+    void handOffChunks();
+    void updateExplosionChunk(ParticleChunk& c, float dt, float dragFactor, int trailSpacing, int trailMinGap, std::vector<SubEmit>& subEmits) const;
+    void emitSubShells();
+    uint32_t allocEmitterList();
+    void burstBounds(const ParticleChunk& chunk, glm::vec3& center, float& radius) const;
+    float trailMinMoveSq(const glm::vec3& center, float radius) const;
+    JobSystem& jobSystem();
+    void runJobs(size_t jobCount, const JobSystem::JobFn& fn);
+};
@@ -0,0 +1,12 @@
+﻿#pragma once
+
+// 内置的烟花类型（所有类型都支持二次爆炸）
+// 爆炸的具体形状、粒子数、寿命等由 ShellCatalog 中的烟花描述决定，类型只用来选择内置描述和通知表现层
+enum class FireworkType {
+    Sphere,          // 球形烟花
+    Ring,            // 环形烟花
+    MultiLayer,      // 多层烟花
+    Spiral,          // 螺旋烟花
+    Heart,           // 心形烟花
+    Image            // 图片烟花
+};
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+
+// Frustum - 由视图投影矩阵提取的视锥体（6 个平面，法线指向视锥体内部）
+// 只做包围球测试：球心到任一平面的有向距离小于 -半径即完全在视锥体外
+struct Frustum {
+    glm::vec4 planes[6];  // xyz = 单位法线，w = 偏移
+    bool valid = false;   // 未设置矩阵前所有测试都通过
+
+    // 从 projection * view 提取平面（OpenGL 裁剪空间 -w <= x, y, z <= w）
+    void setViewProj(const glm::mat4& viewProj) {
+        glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+        glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+        glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+        glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+        planes[0] = row3 + row0; // 左
+        planes[1] = row3 - row0; // 右
+        planes[2] = row3 + row1; // 下
+        planes[3] = row3 - row1; // 上
+        planes[4] = row3 + row2; // 近
+        planes[5] = row3 - row2; // 远
+        for (glm::vec4& p : planes) {
+            float length = glm::length(glm::vec3(p));
+            if (length > 0.0f) p /= length;
+        }
+        valid = true;
+    }
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const {
+        if (!valid) return true;
+        for (const glm::vec4& p : planes) {
+            if (glm::dot(glm::vec3(p), center) + p.w < -radius) return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,70 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+#include <vector>
+#include "Shader.h"
+
+// GpuParticleSystem - 基于变换反馈（transform feedback）的 GPU 粒子模拟
+// 粒子状态常驻两块显存缓冲，每帧由顶点着色器读取一块、写入另一块（乒乓交换），
+// CPU 只负责把新生成的粒子成批追加进去，不再逐帧回传或重新上传全部粒子。
+// 缓冲按环形使用：写满后新粒子覆盖最早的槽位；死亡粒子留在原槽位，由着色器跳过。
+class GpuParticleSystem {
+public:
+    // 显存中的粒子布局（4 个 vec4，与 particle_update.vs 的输入/输出一一对应）
+    struct Particle {
+        glm::vec4 posLife;     // xyz: 位置，w: 剩余寿命
+        glm::vec4 velMaxLife;  // xyz: 速度，w: 最大寿命
+        glm::vec4 color;       // 基础颜色
+        glm::vec4 params;      // x: 尺寸，y: 旋转角度，z: 旋转角速度（0=不旋转），w: 颜色渐变下标
+    };
+
+    explicit GpuParticleSystem(size_t capacity = 1 << 20);
+    ~GpuParticleSystem();
+
+    GpuParticleSystem(const GpuParticleSystem&) = delete;
+    GpuParticleSystem& operator=(const GpuParticleSystem&) = delete;
+
+    // 追加一个新粒子（在下一次 simulate 时随批次一起上传）
+    // delaySteps > 0 时先跳过这么多次 simulate 再加入：一帧的多个子步一起推进时，
+    // 较晚子步中生成的粒子只模拟它出生之后的子步，寿命和位置与 CPU 模拟一致
+    void spawn(const Particle& particle, int delaySteps = 0);
+
+    // 上传待加入的粒子，并在 GPU 上推进一帧（重力、空气阻力、螺旋旋转、寿命）
+    void simulate(float dt, float gravity, float drag);
+
+    // 绘制当前状态（混合、深度写入等渲染状态和纹理单元 0 上的颜色渐变表由调用方设置）；pointScale 为点尺寸比例
+    void render(const glm::mat4& view, const glm::mat4& projection, float pointScale = 1.0f);
+
+    // 清理OpenGL资源
+    void cleanupGL();
+
+    size_t capacity() const { return maxParticles; }
+    size_t activeSlots() const { return usedSlots; } // 参与模拟的槽位数（含已死亡的粒子）
+    GLuint currentBuffer() const { return buffers[current]; }
+
+private:
+    void initGL();
+    void uploadPending();
+    void promoteDelayed();
+    static GLuint buildUpdateProgram(const char* vertexPath);
+
+    size_t maxParticles;
+    size_t usedSlots = 0;     // 环形缓冲中已写入过的槽位数
+    size_t head = 0;          // 下一个新粒子写入的槽位
+    float remainingLife = 0;  // 所有已生成粒子中最长的剩余寿命，归零说明缓冲内全部死亡
+    std::vector<Particle> pending; // 等待上传的新粒子
+
+    // 推迟加入的新粒子及其还需跳过的 simulate 次数
+    struct DelayedParticle {
+        Particle particle;
+        int steps;
+    };
+    std::vector<DelayedParticle> delayed;
+
+    GLuint buffers[2] = { 0, 0 };  // 乒乓缓冲
+    GLuint vaos[2] = { 0, 0 };     // 分别以两块缓冲为顶点来源
+    int current = 0;               // 当前保存最新状态的缓冲
+    GLuint updateProgram = 0;
+    Shader* renderShader = nullptr;
+    bool glInited = false;
+};
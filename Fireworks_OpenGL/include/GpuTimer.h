@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <cstddef>
+
+// GpuTimer - 用 GL_TIME_ELAPSED 查询测量每帧 GPU 耗时
+// 查询对象组成环形队列，结果延迟几帧后再读取（只在结果可用时读取），不会让 CPU 等待 GPU
+class GpuTimer {
+public:
+    explicit GpuTimer(size_t framesInFlight = 4);
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    // 包围一帧的 GPU 命令（需要有效的 OpenGL 上下文）；队列已满时本帧不计时
+    void begin();
+    void end();
+
+    // 取出所有已完成的查询，ms 为其中最新一帧的 GPU 耗时（毫秒）；没有新结果返回 false
+    bool poll(float& ms);
+
+    // 清理OpenGL资源
+    void cleanupGL();
+
+private:
+    std::vector<GLuint> queries;
+    size_t writeIndex = 0;  // 下一帧使用的查询
+    size_t readIndex = 0;   // 最早未读取的查询
+    size_t inFlight = 0;    // 已提交、尚未读取的查询数
+    bool active = false;    // begin 之后、end 之前
+};
@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <cstdint>
+
+// 图片烟花模板：已过滤掉透明像素的点云
+// 每个点只存图片空间中的偏移（已按 4 个单位缩放并居中）和 RGBA8 颜色，共 12 字节
+struct ImagePoint {
+    float offsetX;
+    float offsetY;
+    uint8_t r, g, b, a;
+};
+
+struct ImageTemplate {
+    std::vector<ImagePoint> points;
+    int width = 0;
+    int height = 0;
+};
+
+// ImageTemplateCache - 按路径缓存图片烟花模板
+// 解码（stbi_load + 透明像素过滤）只在第一次请求或后台预加载时进行一次，
+// 之后每次爆炸直接从模板批量实例化粒子，不再在渲染线程上读盘解码
+class ImageTemplateCache {
+public:
+    using TemplatePtr = std::shared_ptr<const ImageTemplate>;
+
+    ImageTemplateCache() = default;
+    ImageTemplateCache(const ImageTemplateCache&) = delete;
+    ImageTemplateCache& operator=(const ImageTemplateCache&) = delete;
+    ~ImageTemplateCache();
+
+    // 在后台线程中预解码一组图片（已缓存或正在加载的路径会被跳过）
+    void preload(const std::vector<std::string>& paths);
+
+    // 获取模板：已缓存则直接返回；正在后台加载则等待其完成；未请求过则同步解码
+    // 加载失败时返回空指针
+    TemplatePtr get(const std::string& path);
+
+    // 是否已解码完成（不阻塞）
+    bool isReady(const std::string& path);
+
+    void clear();
+
+private:
+    static TemplatePtr decode(const std::string& path);
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_future<TemplatePtr>> entries;
+};
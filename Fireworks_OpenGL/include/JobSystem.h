@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+// JobSystem - 工作窃取（work-stealing）线程池
+// 每个线程有自己的任务队列：先从自己队列头部取任务，取空后从其他线程队列尾部“偷”任务。
+// run() 会阻塞调用线程，调用线程本身也作为 0 号工作线程参与执行。
+class JobSystem {
+public:
+    // job: 任务下标 [0, jobCount)；worker: 执行该任务的线程编号 [0, workerCount())
+    using JobFn = std::function<void(size_t job, unsigned worker)>;
+
+    // threadCount = 0 时按硬件线程数创建（包含调用线程）
+    explicit JobSystem(unsigned threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned workerCount() const { return static_cast<unsigned>(queues.size()); }
+
+    // 执行 jobCount 个任务并等待全部完成
+    void run(size_t jobCount, const JobFn& fn);
+
+    // 把 count 个元素切成任务：每个任务至少 minPerJob 个，任务数不超过 workerCount() * 4
+    size_t itemsPerJob(size_t count, size_t minPerJob) const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    bool runOne(unsigned worker);
+    void workerLoop(unsigned worker);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex stateMutex;
+    std::condition_variable wakeCv;   // 通知工作线程有新一批任务
+    std::condition_variable doneCv;   // 通知调用线程任务全部完成
+    const JobFn* current = nullptr;
+    size_t generation = 0;
+    std::atomic<size_t> remaining{ 0 };
+    bool quit = false;
+};
@@ -0,0 +1,96 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// PackedParticleVertex - CPU 粒子上传到 GPU 的紧凑顶点（每个粒子 20 字节）
+// 位置保持 3 个 float；颜色和尺寸共用一个 RGBA8，着色器以归一化 vec4 读取后解码（见 firework.vs）：
+//   rgb = sqrt(颜色 / COLOR_RANGE)：颜色可超过 1（多层烟花），平方根编码让暗色（图片烟花 0~0.2）保留足够精度
+//   a   = 尺寸的对数编码：取 float 位模式按固定步长量化，每级约 2%，覆盖 2^-7 ~ 2
+// 颜色为粒子的初始颜色；随寿命的变化（淡出等）由着色器按归一化年龄查颜色渐变表，
+// 年龄和渐变下标共用最后一个 uint32（两个 uint16）。渲染的粒子 alpha 恒为 1，因此不单独存储
+struct PackedParticleVertex {
+    float x, y, z;
+    uint32_t colorSize; // 内存顺序 R, G, B, 尺寸
+    uint32_t ageRamp;   // 低 16 位：归一化年龄 × 65535，高 16 位：颜色渐变下标
+
+    static constexpr float COLOR_RANGE = 2.0f;
+    static constexpr uint32_t SIZE_BITS_MIN = 0x3C000000u; // 2^-7 的位模式
+    static constexpr uint32_t SIZE_BITS_STEP = 1u << 18;   // 每级 1/32 倍频程
+
+    static uint32_t encodeChannel(float c) {
+        float v = std::sqrt((std::min)((std::max)(c, 0.0f) / COLOR_RANGE, 1.0f));
+        return static_cast<uint32_t>(v * 255.0f + 0.5f);
+    }
+
+    static uint32_t encodeSize(float size) {
+        uint32_t bits;
+        std::memcpy(&bits, &size, sizeof(bits));
+        if (!(size > 0.0f) || bits <= SIZE_BITS_MIN) return 0;
+        return (std::min)((bits - SIZE_BITS_MIN + SIZE_BITS_STEP / 2) / SIZE_BITS_STEP, 255u);
+    }
+
+    static uint32_t encodeAgeRamp(float age, uint32_t ramp) {
+        float a = (std::min)((std::max)(age, 0.0f), 1.0f);
+        return static_cast<uint32_t>(a * 65535.0f + 0.5f) | (ramp << 16);
+    }
+
+    static PackedParticleVertex pack(const glm::vec3& position, const glm::vec4& color, float size, float age, uint32_t ramp) {
+        PackedParticleVertex v;
+        v.x = position.x;
+        v.y = position.y;
+        v.z = position.z;
+        v.colorSize = encodeChannel(color.r) | (encodeChannel(color.g) << 8) | (encodeChannel(color.b) << 16) | (encodeSize(size) << 24);
+        v.ageRamp = encodeAgeRamp(age, ramp);
+        return v;
+    }
+};
+
+static_assert(sizeof(PackedParticleVertex) == 20, "PackedParticleVertex must stay 20 bytes");
+
+// PackedBillboardVertex - 实例化四边形路径的每实例数据（32 字节）
+// 在紧凑顶点之后附加最近一个模拟步的位移（世界坐标），着色器据此把四边形沿屏幕上的运动方向拉长
+struct PackedBillboardVertex {
+    PackedParticleVertex point;
+    float motionX, motionY, motionZ;
+
+    static PackedBillboardVertex pack(const glm::vec3& position, const glm::vec3& motion, const glm::vec4& color, float size, float age, uint32_t ramp) {
+        PackedBillboardVertex v;
+        v.point = PackedParticleVertex::pack(position, color, size, age, ramp);
+        v.motionX = motion.x;
+        v.motionY = motion.y;
+        v.motionZ = motion.z;
+        return v;
+    }
+};
+
+static_assert(sizeof(PackedBillboardVertex) == 32, "PackedBillboardVertex must stay 32 bytes");
+
+// PackedTrailSegment - 带状拖尾的一段（32 字节，实例化四边形的每实例数据）
+// 两端为世界坐标；颜色和尺寸的编码与 PackedParticleVertex 相同；最后一个 uint32 为四个归一化字节：
+//   粒子的归一化年龄、颜色渐变下标（拖尾只支持前 256 条渐变）、两端在拖尾上的位置（0 = 粒子头部，1 = 拖尾末端）
+struct PackedTrailSegment {
+    float x0, y0, z0;
+    float x1, y1, z1;
+    uint32_t colorSize;
+    uint32_t params; // 内存顺序：年龄、渐变下标、起点位置、终点位置
+
+    static uint32_t encodeUnit(float v) {
+        return static_cast<uint32_t>((std::min)((std::max)(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    static PackedTrailSegment pack(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color, float size,
+                                   float age, uint32_t ramp, float t0, float t1) {
+        PackedTrailSegment s;
+        s.x0 = from.x; s.y0 = from.y; s.z0 = from.z;
+        s.x1 = to.x; s.y1 = to.y; s.z1 = to.z;
+        s.colorSize = PackedParticleVertex::encodeChannel(color.r) | (PackedParticleVertex::encodeChannel(color.g) << 8) |
+                      (PackedParticleVertex::encodeChannel(color.b) << 16) | (PackedParticleVertex::encodeSize(size) << 24);
+        s.params = encodeUnit(age) | ((std::min)(ramp, 255u) << 8) | (encodeUnit(t0) << 16) | (encodeUnit(t1) << 24);
+        return s;
+    }
+};
+
+static_assert(sizeof(PackedTrailSegment) == 32, "PackedTrailSegment must stay 32 bytes");
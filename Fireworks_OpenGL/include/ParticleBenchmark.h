@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <cstddef>
+
+class FireworkParticleSystem;
+
+// ParticleBenchmark - 粒子绘制路径基准（GL_POINTS、实例化四边形、解析爆炸）
+// 以固定种子发射同一批烟花，按固定步长模拟到粒子数接近峰值后冻结，
+// 再用前两条路径分别把同一画面画进离屏帧缓冲，GpuTimer 只包围 render()；
+// 解析爆炸需要在爆炸时接管粒子，因此打开 analyticBursts 后重放同一场景再计时。
+// 每帧等待 GPU 完成后读取计时，结果不受查询排队影响；各路径的点亮像素数一并报告，用来确认画面一致
+// （解析爆炸不画拖尾，点亮的像素比前两条路径少）。
+// 由 main.cpp 的 --bench-particles [帧数] 启动（需要有效的 OpenGL 上下文）
+class ParticleBenchmark {
+public:
+    struct Result {
+        size_t particles = 0;       // 冻结时的粒子数（上升弹 + 爆炸粒子）
+        float pointsMs = 0.0f;      // GL_POINTS 每帧平均 GPU 耗时（毫秒）
+        float billboardsMs = 0.0f;  // 实例化四边形每帧平均 GPU 耗时（毫秒）
+        size_t pointsLit = 0;       // 最后一帧被粒子点亮的像素数
+        size_t billboardsLit = 0;
+        float analyticMs = 0.0f;    // 解析爆炸（顶点着色器按时间算位置）每帧平均 GPU 耗时（毫秒）
+        size_t analyticLit = 0;
+        float pointsWallMs = 0.0f;  // 各路径 render() 加 glFinish 的每帧平均墙钟时间（毫秒）
+        float billboardsWallMs = 0.0f;
+        float analyticWallMs = 0.0f;
+    };
+
+    // 会重置 system 的种子并改动其粒子状态、billboards 和 analyticBursts 开关，结束后恢复两个开关
+    static Result run(FireworkParticleSystem& system, int width, int height, int frames);
+};
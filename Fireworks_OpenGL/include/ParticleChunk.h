@@ -0,0 +1,209 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include "TrailRing.h"
+
+// ParticleChunk - 固定容量的粒子块（块内仍为 SoA 布局）
+// 同一次爆炸（或同一帧的拖尾）产生的粒子同时出生、寿命相近，因此放在同一个块里：
+// 块记录自身年龄和块内最大寿命，到期后整块一次性回收，不再逐粒子压缩删除
+struct ParticleChunk {
+    static const int CAPACITY = 256;
+    static const uint32_t NO_BURST = 0xFFFFFFFFu;
+
+    alignas(32) float posX[CAPACITY];
+    alignas(32) float posY[CAPACITY];
+    alignas(32) float posZ[CAPACITY];
+    alignas(32) float prevX[CAPACITY];     // 上一个模拟步的位置（渲染插值用，死亡粒子的值无意义）
+    alignas(32) float prevY[CAPACITY];
+    alignas(32) float prevZ[CAPACITY];
+    alignas(32) float velX[CAPACITY];
+    alignas(32) float velY[CAPACITY];
+    alignas(32) float velZ[CAPACITY];
+    alignas(32) float life[CAPACITY];      // 剩余寿命（<=0 表示已死亡，渲染和更新时跳过）
+    alignas(32) float maxLife[CAPACITY];
+    alignas(32) float sizes[CAPACITY];
+    alignas(32) float rotation[CAPACITY];  // 旋转角度（螺旋烟花）
+    glm::vec4 baseColor[CAPACITY];
+    alignas(32) float trailX[TrailRing::SAMPLES][CAPACITY]; // 拖尾的历史位置（按槽位分平面，记录时整块复制）
+    alignas(32) float trailY[TrailRing::SAMPLES][CAPACITY];
+    alignas(32) float trailZ[TrailRing::SAMPLES][CAPACITY];
+
+    uint32_t burst = NO_BURST; // 所属爆发
+    int count = 0;             // 已写入的粒子数
+    int aliveCount = 0;        // 仍存活的粒子数，归零即可回收整块
+    float age = 0.0f;          // 块年龄（秒）
+    float maxLifetime = 0.0f;  // 块内粒子的最大寿命，age 超过它时整块到期
+    bool offscreen = false;    // 本步所属爆发是否在视锥体外
+    int pendingSteps = 0;      // 离屏降频时累积、尚未积分的步数
+    TrailRing trail;           // 拖尾位置环的游标（块内粒子同步推进，共用一个）
+
+    bool full() const { return count >= CAPACITY; }
+    bool expired() const { return aliveCount <= 0 || age >= maxLifetime; }
+
+    void reset(uint32_t burstIndex) {
+        burst = burstIndex;
+        count = 0;
+        aliveCount = 0;
+        age = 0.0f;
+        maxLifetime = 0.0f;
+        offscreen = false;
+        pendingSteps = 0;
+        trail.reset();
+    }
+
+    void push(const glm::vec3& position, const glm::vec3& velocity, const glm::vec4& color,
+              float lifeTime, float size, float angle) {
+        int i = count++;
+        posX[i] = position.x; posY[i] = position.y; posZ[i] = position.z;
+        prevX[i] = position.x; prevY[i] = position.y; prevZ[i] = position.z;
+        velX[i] = velocity.x; velY[i] = velocity.y; velZ[i] = velocity.z;
+        life[i] = lifeTime;
+        maxLife[i] = lifeTime;
+        sizes[i] = size;
+        rotation[i] = angle;
+        baseColor[i] = color;
+        aliveCount++;
+        maxLifetime = (std::max)(maxLifetime, lifeTime);
+    }
+
+    // 标记粒子死亡（寿命耗尽或落到地面以下）；调用方保证该粒子此前存活
+    void kill(int i) {
+        life[i] = 0.0f;
+        aliveCount--;
+    }
+};
+
+// ParticleChunkArena - 粒子块的固定预算存储：所有块按上限一次性预先分配，运行中不再申请内存
+// 目前只有爆炸粒子块池使用（拖尾的历史位置存放在块内，不再单独占用块），爆炸粒子的总数上限 = 块数 × CAPACITY
+class ParticleChunkArena {
+public:
+    // 设置块数上限：超出已分配数量时追加分配一段；调小时多出的块保留但不再分出
+    void setCapacity(size_t chunkCount) {
+        if (chunkCount > allocated) {
+            size_t extra = chunkCount - allocated;
+            blocks.push_back(std::make_unique<ParticleChunk[]>(extra));
+            ParticleChunk* block = blocks.back().get();
+            for (size_t i = extra; i-- > 0;) freeList.push_back(&block[i]);
+            allocated = chunkCount;
+        }
+        limit = chunkCount;
+    }
+
+    // 预算用尽时返回 nullptr
+    ParticleChunk* acquire() {
+        if (inUse >= limit || freeList.empty()) return nullptr;
+        ParticleChunk* chunk = freeList.back();
+        freeList.pop_back();
+        inUse++;
+        return chunk;
+    }
+
+    void release(ParticleChunk* chunk) {
+        freeList.push_back(chunk);
+        inUse--;
+    }
+
+    size_t capacity() const { return limit; }
+    size_t used() const { return inUse; }
+    size_t available() const { return inUse < limit ? limit - inUse : 0; }
+
+private:
+    std::vector<std::unique_ptr<ParticleChunk[]>> blocks;
+    std::vector<ParticleChunk*> freeList;
+    size_t allocated = 0; // 已分配的块数
+    size_t limit = 0;     // 块数上限
+    size_t inUse = 0;     // 已分出的块数
+};
+
+// ParticleChunkPool - 粒子块池：从块存储中取块，回收后归还
+class ParticleChunkPool {
+public:
+    std::vector<ParticleChunk*> active; // 使用中的块（按分配顺序，越靠前越老）
+
+    explicit ParticleChunkPool(ParticleChunkArena& arena) : arena(arena) {}
+
+    // 预算用尽时返回 nullptr
+    ParticleChunk* acquire(uint32_t burst) {
+        ParticleChunk* chunk = arena.acquire();
+        if (!chunk) return nullptr;
+        chunk->reset(burst);
+        active.push_back(chunk);
+        return chunk;
+    }
+
+    // 回收所有到期的块，onRetire 在回收前对每个块调用一次
+    template <typename RetireFn>
+    void retireExpired(RetireFn onRetire) {
+        auto it = std::remove_if(active.begin(), active.end(), [&](ParticleChunk* chunk) {
+            if (!chunk->expired()) return false;
+            onRetire(*chunk);
+            arena.release(chunk);
+            return true;
+        });
+        active.erase(it, active.end());
+    }
+
+    size_t liveParticleCount() const {
+        size_t n = 0;
+        for (const ParticleChunk* chunk : active) n += chunk->aliveCount;
+        return n;
+    }
+
+    size_t slotCount() const {
+        size_t n = 0;
+        for (const ParticleChunk* chunk : active) n += chunk->count;
+        return n;
+    }
+
+private:
+    ParticleChunkArena& arena;
+};
+
+// ChunkWriter - 向某个爆发追加粒子，当前块写满时自动申请新块
+class ChunkWriter {
+public:
+    ChunkWriter(ParticleChunkPool& pool, uint32_t burst) : pool(pool), burst(burst) {}
+
+    uint32_t burstIndex() const { return burst; }
+
+    // 返回本次是否新申请了块（调用方据此维护爆发引用计数）
+    bool push(const glm::vec3& position, const glm::vec3& velocity, const glm::vec4& color,
+              float life, float size, float angle = 0.0f) {
+        bool newChunk = false;
+        if (!current || current->full()) {
+            current = pool.acquire(burst);
+            if (!current) return false; // 超出粒子预算：丢弃
+            newChunk = true;
+        }
+        current->push(position, velocity, color, life, size, angle);
+        return newChunk;
+    }
+
+    // 批量申请槽位：在当前块（写满则换新块）中连续占用至多 want 个槽位，
+    // first/got 返回起始下标和实际数量，各数组由调用方直接填写；超出粒子预算时返回 nullptr
+    ParticleChunk* claim(int want, float lifeTime, int& first, int& got, bool& newChunk) {
+        newChunk = false;
+        if (!current || current->full()) {
+            current = pool.acquire(burst);
+            if (!current) {
+                first = got = 0;
+                return nullptr;
+            }
+            newChunk = true;
+        }
+        first = current->count;
+        got = (std::min)(want, ParticleChunk::CAPACITY - first);
+        current->count += got;
+        current->aliveCount += got;
+        current->maxLifetime = (std::max)(current->maxLifetime, lifeTime);
+        return current;
+    }
+
+private:
+    ParticleChunkPool& pool;
+    uint32_t burst;
+    ParticleChunk* current = nullptr;
+};
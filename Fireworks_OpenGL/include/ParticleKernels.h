@@ -0,0 +1,26 @@
+﻿#pragma once
+#include "ParticleChunk.h"
+
+// ParticleKernels - 粒子块的向量化积分 / 年龄 / 拖尾位移内核
+// 每个内核都有标量、SSE2（一次 4 个粒子）、AVX2（一次 8 个粒子）三个版本，运行时按 CPU 支持选择。
+// 各版本对每个粒子执行完全相同的单精度运算（同样的顺序、不使用 FMA），结果逐位一致，
+// 因此可以随时切换到标量版本对照。
+namespace ParticleKernels {
+
+enum class Level { Scalar, SSE2, AVX2 };
+
+// 当前 CPU 支持的最高级别（首次调用时检测）
+Level bestLevel();
+const char* levelName(Level level);
+
+// 积分块内存活粒子：prev = pos; pos += vel*dt; velY += gravityStep; vel *= drag; life -= dt
+// 寿命耗尽或落到地面以下的粒子标记为死亡（life = 0，aliveCount 相应减少）
+void integrate(Level level, ParticleChunk& c, float dt, float gravityStep, float drag);
+
+// 归一化年龄：1 - life / maxLife（0 = 出生，1 = 死亡），渲染时作为颜色渐变的查表坐标
+void normalizedAge(Level level, const float* life, const float* maxLife, float* out, int count);
+
+// 块内粒子当前位置与拖尾槽位 slot 中的采样之间的最大距离的平方（决定是否记录新的拖尾采样）
+float maxTrailMoveSq(Level level, const ParticleChunk& c, int slot);
+
+}
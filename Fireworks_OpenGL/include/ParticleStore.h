@@ -0,0 +1,123 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "TrailRing.h"
+
+// ParticleStore - 粒子的结构化数组（SoA）存储
+// 热数据（位置/速度/寿命/尺寸）按分量各自连续存放，update() 只遍历真正用到的数组；
+// 冷数据（烟花类型、辅色、图片路径等）不放在这里，而是按“爆发”存一份，粒子只记录爆发下标
+class ParticleStore {
+public:
+    static const uint32_t NO_BURST = 0xFFFFFFFFu; // 不属于任何爆发
+
+    // 热数据：每帧积分都会读写
+    std::vector<float> posX, posY, posZ;   // 位置
+    std::vector<float> prevX, prevY, prevZ; // 上一个模拟步的位置（渲染插值用）
+    std::vector<float> velX, velY, velZ;   // 速度
+    std::vector<float> life;               // 剩余寿命（秒）
+    std::vector<float> maxLife;            // 最大寿命（用于计算生命周期比例）
+    std::vector<float> sizes;              // 规格化尺寸
+
+    // 温数据：仅部分粒子/渲染时使用
+    std::vector<float> rotation;           // 旋转角度（螺旋烟花）
+    std::vector<glm::vec4> baseColor;      // 初始颜色（颜色渐变的基准，多层/图片烟花逐粒子不同）
+    std::vector<uint32_t> burst;           // 所属爆发下标
+
+    // 拖尾：全部粒子同步推进，共用一个位置环游标；历史位置按粒子连续存放（粒子 i 的槽位 s 在 i * SAMPLES + s）
+    TrailRing trail;
+    std::vector<glm::vec3> trailPositions;
+    std::vector<uint8_t> trailFilled;      // 每个粒子已记录的采样数（晚于游标出生的粒子较少）
+
+    size_t count() const { return life.size(); }
+    size_t capacity() const { return life.capacity(); }
+    bool empty() const { return life.empty(); }
+
+    void reserve(size_t n) {
+        posX.reserve(n); posY.reserve(n); posZ.reserve(n);
+        prevX.reserve(n); prevY.reserve(n); prevZ.reserve(n);
+        velX.reserve(n); velY.reserve(n); velZ.reserve(n);
+        life.reserve(n); maxLife.reserve(n); sizes.reserve(n);
+        rotation.reserve(n); baseColor.reserve(n); burst.reserve(n);
+        trailPositions.reserve(n * TrailRing::SAMPLES); trailFilled.reserve(n);
+    }
+
+    void clear() {
+        posX.clear(); posY.clear(); posZ.clear();
+        prevX.clear(); prevY.clear(); prevZ.clear();
+        velX.clear(); velY.clear(); velZ.clear();
+        life.clear(); maxLife.clear(); sizes.clear();
+        rotation.clear(); baseColor.clear(); burst.clear();
+        trailPositions.clear(); trailFilled.clear();
+        trail.reset();
+    }
+
+    // 追加一个粒子，返回其下标
+    size_t push(const glm::vec3& position, const glm::vec3& velocity, const glm::vec4& color,
+                float lifeTime, float size, uint32_t burstIndex = NO_BURST, float angle = 0.0f) {
+        posX.push_back(position.x); posY.push_back(position.y); posZ.push_back(position.z);
+        prevX.push_back(position.x); prevY.push_back(position.y); prevZ.push_back(position.z);
+        velX.push_back(velocity.x); velY.push_back(velocity.y); velZ.push_back(velocity.z);
+        life.push_back(lifeTime);
+        maxLife.push_back(lifeTime);
+        sizes.push_back(size);
+        rotation.push_back(angle);
+        baseColor.push_back(color);
+        burst.push_back(burstIndex);
+        trailPositions.resize(trailPositions.size() + TrailRing::SAMPLES, position);
+        trailFilled.push_back(0);
+        return life.size() - 1;
+    }
+
+    glm::vec3 position(size_t i) const { return glm::vec3(posX[i], posY[i], posZ[i]); }
+    glm::vec3 previousPosition(size_t i) const { return glm::vec3(prevX[i], prevY[i], prevZ[i]); }
+    glm::vec3 velocity(size_t i) const { return glm::vec3(velX[i], velY[i], velZ[i]); }
+
+    // 把粒子 i 的位置记到拖尾槽位 slot（slot 由 trail.advance 给出）
+    void recordTrail(size_t i, int slot, const glm::vec3& position) {
+        trailPositions[i * TrailRing::SAMPLES + slot] = position;
+        if (trailFilled[i] < TrailRing::SAMPLES) trailFilled[i]++;
+    }
+    const glm::vec3& trailPosition(size_t i, int slot) const { return trailPositions[i * TrailRing::SAMPLES + slot]; }
+
+    // 按谓词压缩删除（保持剩余粒子的相对顺序），onRemove 在删除前对每个被删粒子调用一次
+    template <typename DeadPred, typename RemoveFn>
+    void removeIf(DeadPred isDead, RemoveFn onRemove) {
+        size_t n = count();
+        size_t w = 0;
+        for (size_t r = 0; r < n; ++r) {
+            if (isDead(r)) {
+                onRemove(r);
+                continue;
+            }
+            if (w != r) move(r, w);
+            ++w;
+        }
+        resize(w);
+    }
+
+private:
+    void move(size_t from, size_t to) {
+        posX[to] = posX[from]; posY[to] = posY[from]; posZ[to] = posZ[from];
+        prevX[to] = prevX[from]; prevY[to] = prevY[from]; prevZ[to] = prevZ[from];
+        velX[to] = velX[from]; velY[to] = velY[from]; velZ[to] = velZ[from];
+        life[to] = life[from];
+        maxLife[to] = maxLife[from];
+        sizes[to] = sizes[from];
+        rotation[to] = rotation[from];
+        baseColor[to] = baseColor[from];
+        burst[to] = burst[from];
+        std::copy_n(trailPositions.begin() + from * TrailRing::SAMPLES, TrailRing::SAMPLES, trailPositions.begin() + to * TrailRing::SAMPLES);
+        trailFilled[to] = trailFilled[from];
+    }
+
+    void resize(size_t n) {
+        posX.resize(n); posY.resize(n); posZ.resize(n);
+        prevX.resize(n); prevY.resize(n); prevZ.resize(n);
+        velX.resize(n); velY.resize(n); velZ.resize(n);
+        life.resize(n); maxLife.resize(n); sizes.resize(n);
+        rotation.resize(n); baseColor.resize(n); burst.resize(n);
+        trailPositions.resize(n * TrailRing::SAMPLES); trailFilled.resize(n);
+    }
+};
@@ -33,18 +33,44 @@ public:
         }
     }
 
+    // ԹģÿΪһĸ˹ģʵã
+    void SetBlurPasses(int passes) { blurPasses = passes < 0 ? 0 : passes; }
+    int GetBlurPasses() const { return blurPasses; }
+
+    // Ⱦֱʱ0.25~1ͻԹС֡ȾRender ʱ쵽ڴС
+    void SetRenderScale(float scale);
+    float GetRenderScale() const { return renderScale; }
+
+    // ӻֱʱ0.25~1Գ֡壩С 1 ʱӻƵͷֱ HDR 壬
+    // Сĳڵȸ֪ϲϳɻسڻԹ֮ǰٽӵ俪
+    void SetParticleResolution(float scale);
+    float GetParticleResolution() const { return particleResolution; }
+
+    // ӻǰãӻֱΪ 1 ʱʲôֱӻ֡
+    void BeginParticles();
+    void EndParticles();
+
+    //  / Զü棨ϲʱȻԭΪԾ룩
+    void SetDepthRange(float nearPlane, float farPlane) { depthNear = nearPlane; depthFar = farPlane; }
+
 private:
     void initFramebuffer();
     void initRenderData();
     void initBloomBuffers();  // ʼԹ FBO/
     void applyBloom();        // ִлԹ
+    void releaseBuffers();    // ɾͻԹ֡壨ıȾֱʱؽ
+    void initParticleBuffers();    // ʼͷֱӻ壨һʹʱ
+    void releaseParticleBuffers();
 
     unsigned int FBO;
-    unsigned int RBO;
+    unsigned int depthTexture;  //  + ģ壨ϲȡ
     unsigned int textureColorBuffer;
 
     unsigned int quadVAO, quadVBO;
-    unsigned int width, height;
+    unsigned int width, height;              // ڴС
+    unsigned int renderWidth, renderHeight;  // ֡СڴС  renderScale
+    float renderScale = 1.0f;
+    int blurPasses = 8;                      // ģЧ
 
     // Ping-pong ģ FBO
     unsigned int pingpongFBO[2];
@@ -54,6 +80,16 @@ private:
     Shader *postShader = nullptr;
     Shader *bloomShader = nullptr; // ȡ
     Shader *blurShader = nullptr;  // ˹ģ
+    Shader *upsampleShader = nullptr; // ӻϲ
+
+    // ͷֱӻ
+    float particleResolution = 1.0f;
+    unsigned int particleWidth = 0, particleHeight = 0;
+    unsigned int particleFBO = 0;
+    unsigned int particleColorBuffer = 0;  // ɫԤ alpha
+    unsigned int particleDepthBuffer = 0;  // Сĳ
+    unsigned int compositeFBO = 0;         // ֻҳɫϳʱȡȲγɷ·
+    float depthNear = 0.1f, depthFar = 200.0f;
 
     // ģڵ pingpong0 1
     int lastBlurTextureIndex = -1; // -1 ʾδģ
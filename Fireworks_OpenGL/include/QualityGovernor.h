@@ -0,0 +1,51 @@
+﻿#pragma once
+#include <vector>
+
+// QualityGovernor - 自适应画质调节
+// 每帧输入 CPU / GPU 帧时间，取两者中较慢的一方做指数滑动平均，与帧时间预算比较：
+//   - 平均帧时间持续超出预算 downshiftSeconds 秒，降一级画质
+//   - 持续低于预算 × upshiftRatio 达 upshiftSeconds 秒，升一级画质
+// 升降级使用不同的阈值和持续时间（迟滞），避免在两级之间来回抖动。
+// 每级画质对应一组参数（粒子数比例、拖尾密度、辉光模糊次数、渲染分辨率、粒子缓冲分辨率），由调用方应用到各模块
+class QualityGovernor {
+public:
+    // 一级画质的参数
+    struct Level {
+        float particleScale;    // 每次爆炸的粒子数比例
+        int tailStride;         // 拖尾密度（每 tailStride 个粒子一个拖尾）
+        int blurPasses;         // 辉光模糊次数
+        float resolutionScale;  // 场景渲染分辨率比例
+        float particleResolution; // 粒子缓冲分辨率比例（相对场景，1 = 直接画进场景）
+    };
+
+    QualityGovernor();
+
+    // 每帧调用：deltaTime 为帧间隔（秒），cpuMs / gpuMs 为本帧 CPU / GPU 耗时（毫秒，gpuMs < 0 表示本帧没有 GPU 计时结果）
+    // 画质级别变化时返回 true
+    bool update(float deltaTime, float cpuMs, float gpuMs);
+
+    // 当前画质级别（0 = 最高画质）及其参数
+    int level() const { return current; }
+    int levelCount() const { return static_cast<int>(levels.size()); }
+    const Level& settings() const { return levels[current]; }
+
+    // 最近的平均帧时间（毫秒）
+    float averageCpuMs() const { return cpuAverage; }
+    float averageGpuMs() const { return gpuAverage; }
+
+    // 调节参数
+    bool enabled = true;
+    float budgetMs = 16.0f;         // 帧时间预算（60 Hz 留出少量余量）
+    float upshiftRatio = 0.7f;      // 低于预算的这个比例才允许升级
+    float downshiftSeconds = 0.5f;  // 持续超出预算多久后降级
+    float upshiftSeconds = 3.0f;    // 持续低于阈值多久后升级
+    float smoothing = 0.1f;         // 滑动平均系数（越大越灵敏）
+
+private:
+    std::vector<Level> levels;
+    int current = 0;
+    float cpuAverage = 0.0f;
+    float gpuAverage = 0.0f;
+    float overTime = 0.0f;          // 连续超出预算的时间（秒）
+    float underTime = 0.0f;         // 连续低于升级阈值的时间（秒）
+};
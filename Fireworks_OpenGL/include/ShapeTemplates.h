@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// 爆炸形状
+enum class ShapeKind : uint8_t {
+    Sphere,  // 球面均匀分布
+    Ring,    // 水平圆环
+    Spiral,  // 3 条螺旋线
+    Heart,   // 心形参数曲线
+    Image    // 图片点云（不在这里建表，由 ImageTemplateCache 提供）
+};
+
+// 单位尺寸的烟花形状模板：每个粒子的速度方向/形状分量（不含随机抖动），以及初始角度
+struct ShapeTemplate {
+    std::vector<glm::vec3> velocity;
+    std::vector<float> angle;
+};
+
+// 形状模板的只读视图：第 k 个粒子取 velocity[k & mask] / angle[k & mask]
+struct ShapeView {
+    const glm::vec3* velocity = nullptr;
+    const float* angle = nullptr;
+    uint32_t mask = 0;
+};
+
+// ShapeTemplates - 预先计算的烟花形状
+// acos / sin / cos / pow 只在建表时计算一次，爆炸时按半径缩放模板再叠加少量随机抖动即可：
+//   - 球形：一张固定的球面均匀随机方向表，每次爆炸随机选起点和奇数步长取出一组不重复的方向
+//   - 环形 / 螺旋 / 心形：形状只取决于粒子数，按粒子数缓存
+// 只在模拟线程上使用（不加锁）
+class ShapeTemplates {
+public:
+    static const uint32_t SPHERE_DIRECTIONS = 4096; // 必须是 2 的幂（奇数步长才能遍历所有方向）
+
+    ShapeTemplates();
+
+    // 预先建好指定形状和粒子数的模板（加载烟花描述时调用，避免第一次爆炸时建表）
+    void warm(ShapeKind kind, int count) { view(kind, count); }
+
+    // 取得形状模板；球形与粒子数无关，其余按粒子数缓存
+    ShapeView view(ShapeKind kind, int count);
+
+private:
+    const ShapeTemplate& ring(int count);   // velocity = (cos, 0, sin)
+    const ShapeTemplate& spiral(int count); // velocity = 水平方向 × 半径系数（0.8 × 0.4~1.2）
+    const ShapeTemplate& heart(int count);  // velocity = 心形参数方程 (x, y, 0)，按半径 1 缩放
+
+    ShapeTemplate sphere;
+    std::map<int, ShapeTemplate> rings, spirals, hearts;
+};
@@ -0,0 +1,114 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include "FireworkType.h"
+#include "ShapeTemplates.h"
+
+// 一次发射的颜色来源
+enum class ShellColor : uint8_t {
+    Primary,    // 主色
+    Secondary,  // 辅色（单色烟花回退到主色）
+    White       // 白色
+};
+
+// SpawnOp - 编译后的发射指令（一行 emit 对应一条）
+// 字段全部是数值，执行时不再解析文本，也不按烟花类型分支：所有形状共用同一个生成循环
+//   速度 = (模板方向 × radius × (radialBase + radialJitter × r0) + lift + jitter × (r1, r2, r3)) × speed
+//   寿命 = lifeBase + lifeJitter × r4，尺寸 = childSize × sizeScale，颜色 = 来源颜色 × tint
+// 设置了 sub 的指令是子发射器：每个粒子在 subTime 秒时（0 = 寿命结束时）熄灭，并在原地按 sub 烟花爆开，
+// 子粒子继承熄灭时的速度（如十字分裂 crossette、冠菊 kamuro、菊变椰 palm）
+struct SpawnOp {
+    ShapeKind shape = ShapeKind::Sphere;
+    ShellColor color = ShellColor::Primary;
+    bool tail = true;             // 是否产生拖尾
+    int count = 150;              // 粒子数
+    float radius = 4.0f;
+    float radialBase = 1.0f;
+    float radialJitter = 0.0f;
+    glm::vec3 lift = glm::vec3(0.0f);
+    glm::vec3 jitter = glm::vec3(0.0f);
+    float speed = 2.0f;
+    float lifeBase = 0.4f;
+    float lifeJitter = 0.15f;
+    float sizeScale = 1.0f;
+    glm::vec3 tint = glm::vec3(1.0f);
+    float spin = 0.0f;            // 水平速度绕 Y 轴的旋转角速度（螺旋烟花为 3）
+    uint16_t ramp = 0;            // 颜色渐变（ShellCatalog::ramp 的下标，0 = 默认的末段淡出）
+    uint32_t sub = 0xFFFFFFFFu;   // 子烟花（ShellCatalog 的下标，NOT_FOUND = 没有子发射）
+    float subTime = 0.0f;         // 子发射时刻（粒子年龄，秒；0 = 寿命结束时）
+};
+
+// ColorRamp - 颜色随寿命的变化（在顶点着色器中按归一化年龄查表，CPU 不再逐帧计算颜色）
+// 关键点按年龄（0 = 出生，1 = 死亡）升序排列，相邻关键点之间线性插值；
+// 取值 rgb 为颜色倍数，a 为先向白色混合的比例：颜色 = mix(粒子颜色, 白色, a) × rgb
+struct ColorRamp {
+    struct Key {
+        float age;
+        glm::vec4 value;
+    };
+    std::string name;
+    std::vector<Key> keys;
+
+    glm::vec4 sample(float age) const;
+};
+
+// 一个阶段：爆炸后 delay 秒执行 [firstOp, firstOp + opCount) 的发射指令
+struct ShellStage {
+    float delay = 0.0f;
+    uint32_t firstOp = 0;
+    uint32_t opCount = 0;
+};
+
+// 一种烟花：[firstStage, firstStage + stageCount) 的阶段，按 delay 升序排列
+struct ShellProgram {
+    std::string name;
+    FireworkType type = FireworkType::Sphere; // 通知音效/光源时使用的类型
+    uint32_t firstStage = 0;
+    uint32_t stageCount = 0;
+};
+
+// ShellCatalog - 烟花描述目录
+// 烟花描述是纯文本（格式见 ShellCatalog.cpp 中的内置描述和 assets/shells/*.shells），
+// 加载时编译成扁平的阶段 / 发射指令数组；新增烟花只需编辑描述文件，不需要重新编译。
+// 同名描述后加载的覆盖先加载的
+class ShellCatalog {
+public:
+    static const uint32_t NOT_FOUND = 0xFFFFFFFFu;
+
+    ShellCatalog(); // 编译内置描述（6 种 FireworkType）
+
+    // 加载描述文件 / 文本，返回成功编译的烟花数量；语法错误的行会打印并跳过
+    int loadFile(const std::string& path);
+    int loadText(const std::string& text, const std::string& sourceName);
+
+    uint32_t find(const std::string& name) const;
+    uint32_t forType(FireworkType type) const { return builtin[static_cast<int>(type)]; } // 同名的自定义描述优先
+
+    const ShellProgram& shell(uint32_t id) const { return shells[id]; }
+    const ShellStage& stage(uint32_t index) const { return stages[index]; }
+    const SpawnOp& op(uint32_t index) const { return ops[index]; }
+    const std::vector<SpawnOp>& allOps() const { return ops; }
+    size_t size() const { return shells.size(); }
+
+    // 颜色渐变：下标 0 为默认的 fade；同名渐变重新定义时保持原下标
+    uint32_t findRamp(const std::string& name) const;
+    const ColorRamp& ramp(uint32_t index) const { return ramps[index]; }
+    size_t rampCount() const { return ramps.size(); }
+    uint32_t rampRevision() const { return rampRev; } // 渐变每次增加或修改后加一（渲染器据此重建纹理）
+
+    // 把所有渐变按年龄均匀采样成 width 列的表（每条渐变一行，行优先）
+    std::vector<glm::vec4> bakeRamps(int width) const;
+
+private:
+    std::vector<ShellProgram> shells;
+    std::vector<ShellStage> stages;
+    std::vector<SpawnOp> ops;
+    std::unordered_map<std::string, uint32_t> byName;
+    std::vector<ColorRamp> ramps;
+    std::unordered_map<std::string, uint32_t> rampByName;
+    uint32_t rampRev = 0;
+    uint32_t builtin[6] = {};       // 各 FireworkType 当前使用的描述（每次加载后按名称重新查找）
+};
@@ -0,0 +1,90 @@
+﻿#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include "FireworkSimulation.h"
+
+// 演出时间线（.fwshow）的二进制布局：文件头 + 字符串表 + 按时间升序排列的定长发射指令
+// 全部为小端定长字段、8 字节对齐，可以直接内存映射，也可以按块顺序读取
+struct ShowHeader {
+    static const uint32_t VERSION = 1;
+    static const uint32_t HAS_SEED = 1u;
+
+    char magic[8];          // "FWSHOW\0\0"
+    uint32_t version;
+    uint32_t flags;
+    uint64_t seed;          // 演出种子（flags & HAS_SEED 时有效）
+    uint32_t cueCount;
+    uint32_t stringCount;
+    uint32_t stringBytes;   // 字符串表字节数（各字符串以 '\0' 结尾，末尾补齐到 8 字节）
+    uint32_t reserved;
+};
+
+// 一条发射指令（cue）
+struct ShowCue {
+    static const uint32_t NO_STRING = 0xFFFFFFFFu;
+
+    float time;             // 演出开始后的发射时间（秒）
+    uint32_t shell;         // 烟花名称（字符串表下标）
+    uint32_t image;         // 图片烟花的图片路径（字符串表下标，NO_STRING = 默认图片）
+    float life;             // 上升弹寿命
+    float size;             // 上升弹尺寸
+    float position[3];      // 发射位置（(0, 0.5, 0) = 随机位置）
+    float primary[3];       // 主色
+    float secondary[3];     // 辅色（(1, 1, 1) = 单色烟花）
+};
+
+static_assert(sizeof(ShowHeader) == 40, "ShowHeader layout");
+static_assert(sizeof(ShowCue) == 56, "ShowCue layout");
+
+// ShowTimeline - 演出脚本编译器
+// 脚本为纯文本，每行一条发射指令（# 之后为注释，时间不必有序）：
+//   seed <n>                                                  固定演出种子（可选）
+//   <时间> <烟花名称> [pos=x,y,z] [color=r,g,b] [color2=r,g,b] [life=] [size=] [image=路径]
+// 编译时按时间稳定排序并写成 .fwshow 文件，播放时不再解析文本
+class ShowTimeline {
+public:
+    // 编译脚本，返回写入的发射指令数量（失败返回 -1）；语法错误的行会打印并跳过
+    static int compile(const std::string& scriptPath, const std::string& timelinePath);
+};
+
+// ShowPlayer - 演出播放器
+// 从 .fwshow 文件按块流式读取发射指令，内存中只保留一块；每帧从游标开始发射所有到时的指令，
+// 与演出总长度无关，几千条指令的长演出也只占一块缓冲
+class ShowPlayer {
+public:
+    static const size_t BLOCK_CUES = 256; // 每次从磁盘读取的指令数
+
+    // 打开时间线文件（只读入文件头和字符串表）；烟花名称在发射时到烟花描述目录中查找，找不到的指令跳过
+    bool open(const std::string& timelinePath);
+    void close();
+
+    // 从头开始播放（时间线带种子时重设演出种子）
+    void start(FireworkSimulation& sim);
+    void stop() { playing = false; }
+
+    // 推进演出时钟并发射所有到时的指令（每帧调用，deltaTime 单位：秒）；同一帧到时的指令整批发射
+    void update(float deltaTime, FireworkSimulation& sim);
+
+    bool isPlaying() const { return playing; }
+    bool finished() const { return cuesRead == header.cueCount && cursor == blockCount; }
+    float time() const { return clock; }
+    uint32_t cueCount() const { return header.cueCount; }
+
+private:
+    bool refill();
+
+    std::ifstream file;
+    ShowHeader header = {};
+    std::streamoff cueOffset = 0;         // 第一条指令在文件中的偏移
+    std::vector<std::string> strings;     // 字符串表
+    std::vector<ShowCue> block;           // 当前读入的一块指令
+    size_t blockCount = 0;                // 当前块中的有效指令数
+    size_t cursor = 0;                    // 下一条待发射指令在块中的下标
+    uint32_t cuesRead = 0;                // 已从文件读入的指令数
+    float clock = 0.0f;                   // 演出时钟（秒）
+    std::vector<FireworkSimulation::LaunchRequest> batch; // 本帧到时的指令（复用，不逐帧分配）
+    bool playing = false;
+};
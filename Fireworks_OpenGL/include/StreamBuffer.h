@@ -0,0 +1,39 @@
+﻿#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+
+// StreamBuffer - 每帧重写的顶点流缓冲（可容纳多帧数据的环形缓冲）
+// 每帧在上一帧数据之后追加一段，以 GL_MAP_UNSYNCHRONIZED_BIT 映射直接写入，驱动无需等待 GPU；
+// 尾部放不下时用 GL_MAP_INVALIDATE_BUFFER_BIT 孤立（orphan）整块缓冲，驱动换一块新存储从头写起，
+// GPU 仍在读取的旧数据不会被覆盖，因此不需要栅栏同步
+class StreamBuffer {
+public:
+    explicit StreamBuffer(size_t framesInFlight = 3);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // 创建缓冲（需要有效的 OpenGL 上下文）；VAO 设置顶点属性前先调用
+    void initGL(size_t initialBytes);
+
+    // 映射一段至少 bytes 字节的区域并绑定到 GL_ARRAY_BUFFER，offset 返回其在缓冲中的字节偏移（64 字节对齐）
+    // 单帧数据超过容量的 1/framesInFlight 时自动扩容；映射失败返回 nullptr
+    void* map(size_t bytes, size_t& offset);
+
+    // 结束写入，bytesWritten 为实际写入的字节数；返回 false 表示缓冲内容已失效，本帧不应绘制
+    bool unmap(size_t bytesWritten);
+
+    GLuint buffer() const { return vbo; }
+    size_t capacity() const { return capacityBytes; }
+
+    // 清理OpenGL资源
+    void cleanupGL();
+
+private:
+    size_t framesInFlight;
+    size_t capacityBytes = 0;
+    size_t head = 0;          // 下一帧数据的起始偏移
+    size_t mappedOffset = 0;  // 当前映射区域的起始偏移
+    GLuint vbo = 0;
+};
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+// TrailRing - 拖尾位置环的游标
+// 一组同步推进的粒子（同一个粒子块，或全部上升粒子）共用一个游标：需要采样时把这组粒子积分前的位置
+// 记到最老的槽位，每个粒子最多保留 SAMPLES 个历史位置。渲染时从粒子当前（插值后）的位置
+// 依次连到这些历史位置，画成面向相机的带状拖尾，拖尾占用的内存按粒子固定，不再随帧数增加粒子。
+// 采样不按固定间隔：模拟按屏幕上的位移决定何时记录，因此每个槽位带有记录时的步数，渲染按实际时间差定位
+struct TrailRing {
+    static const int SAMPLES = 6;
+
+    int newest = SAMPLES - 1; // 最新采样所在的槽位
+    int filled = 0;           // 已记录的采样数（不超过 SAMPLES）
+    int clock = 0;            // 已推进的模拟步数
+    int stamp[SAMPLES] = {};  // 各槽位记录时的 clock
+
+    // 每个模拟步开始时调用一次
+    void tick() { ++clock; }
+
+    // 记录一个采样，返回要写入的槽位
+    int record() {
+        newest = (newest + 1) % SAMPLES;
+        if (filled < SAMPLES) filled++;
+        stamp[newest] = clock;
+        return newest;
+    }
+
+    void reset() {
+        newest = SAMPLES - 1;
+        filled = 0;
+        clock = 0;
+    }
+
+    // 第 k 新的采样（k = 0 为最新）所在的槽位
+    int slot(int k) const { return (newest - k + SAMPLES) % SAMPLES; }
+
+    // 第 k 新的采样比最近一步积分前的位置早多少步（采样的是记录那一步积分前的位置）
+    int age(int k) const { return clock - stamp[slot(k)]; }
+};
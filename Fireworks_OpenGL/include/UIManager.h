@@ -132,6 +132,7 @@ public:
     void SetFireworkCount(int count);
     void SetFireworkType(int type);
     void SetFPS(float fps);
+    void SetQualityLevel(int level, int levelCount); // Ӧʼ0 = ߻ʣʱʾ FPS 棩
     void SetMouseEnabled(bool enabled);
     void SetSceneLightsEnabled(bool enabled);
     void SetAutoTestMode(bool enabled);
@@ -171,6 +172,8 @@ private:
 
     // ڲ״̬
     int fireworkCount = 0;
+    int qualityLevel = 0;
+    int qualityLevelCount = 1;
 
     // ϵͳ
     struct ArtTextInfo {
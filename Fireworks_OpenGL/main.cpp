@@ -4,6 +4,10 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <stdexcept>
 
@@ -14,6 +18,10 @@
 #include "include/Model.h"
 #include "include/PointLight.h"
 #include "include/FireworkParticleSystem.h"
+#include "include/ShowTimeline.h"
+#include "include/QualityGovernor.h"
+#include "include/GpuTimer.h"
+#include "include/ParticleBenchmark.h"
 #include "include/PostProcessor.h"
 #include "include/TextRenderer.h"
 #include "include/UIManager.h"
@@ -25,6 +33,10 @@
 const unsigned int SCR_WIDTH = 1280;
 const unsigned int SCR_HEIGHT = 720;
 
+// 透视投影的近 / 远裁剪面（粒子上采样按同一范围把深度还原为线性距离，见 PostProcessor::SetDepthRange）
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 200.0f;
+
 // 摄像机 - 调整为从上前方角度查看书本
 Camera camera(glm::vec3(0.0f, 4.5f, 10.0f));  // 调整距离和高度以更好地查看书本
 float lastX = SCR_WIDTH / 2.0f;
@@ -48,6 +60,11 @@ PointLightManager lightManager;
 // 烟花粒子系统（全局变量，以便在 processInput 中访问）
 FireworkParticleSystem fireworkSystem;
 
+// 演出播放器（按 P 播放 assets/shows/demo.show）
+ShowPlayer showPlayer;
+// demo.show 启动时编译到的时间线文件（系统临时目录，不写入 assets；编译失败时为空）
+std::string demoTimelinePath;
+
 // PostProcessor 全局指针（用于窗口缩放时更新）
 PostProcessor* postProcessor = nullptr;
 
@@ -57,12 +74,21 @@ UIManager* uiManager = nullptr;
 // 跟踪按键次数
 int g_fireworkKeyPressCount = 0;  // 记录发射按键按下的次数
 
-int main()
+int main(int argc, char** argv)
 {
+    // 命令行：--bench-particles [帧数] 只运行粒子绘制路径基准（GL_POINTS、实例化四边形、解析爆炸，见 ParticleBenchmark.h），输出结果后退出
+    int benchFrames = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bench-particles") == 0) {
+            benchFrames = (i + 1 < argc) ? (std::max)(std::atoi(argv[i + 1]), 1) : 100;
+        }
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (benchFrames > 0) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // 基准画进离屏帧缓冲，不显示窗口
 
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Firework System", NULL, NULL);
     if (window == NULL)
@@ -92,6 +118,13 @@ int main()
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    if (benchFrames > 0) {
+        ParticleBenchmark::run(fireworkSystem, SCR_WIDTH, SCR_HEIGHT, benchFrames);
+        fireworkSystem.cleanupGL();
+        glfwTerminate();
+        return 0;
+    }
+
     // 初始化UI管理器
     uiManager = new UIManager();
     if (!uiManager->Initialize(SCR_WIDTH, SCR_HEIGHT)) {
@@ -150,6 +183,7 @@ int main()
     std::cout << "Model: Book model (loaded with Assimp)" << std::endl;
     std::cout << "Scene lights: 4 permanent lights added" << std::endl;
     std::cout << "Note: Fireworks create temporary lights that illuminate the scene" << std::endl;
+    std::cout << "Show seed: " << fireworkSystem.seed() << " (FireworkSimulation::setSeed replays this show)" << std::endl;
     std::cout << "Controls:" << std::endl;
     std::cout << "  WASD - Move camera" << std::endl;
     std::cout << "  Space/Shift - Up/Down" << std::endl;
@@ -168,20 +202,60 @@ int main()
     std::cout << "  5 - Launch Spiral firework (Gold)" << std::endl;
     std::cout << "  6 - Launch Sphere firework (Purple) - All types have double explosion" << std::endl;
     std::cout << "  0 - Run auto test sequence" << std::endl;
+    std::cout << "  P - Play scripted show (assets/shows/demo.show)" << std::endl;
+    std::cout << "  B - Toggle particle path (GL_POINTS / instanced billboards)" << std::endl;
+    std::cout << "  G - Toggle particle simulation (CPU / GPU transform feedback)" << std::endl;
+    std::cout << "  N - Toggle analytic bursts (closed-form explosion particles in the vertex shader)" << std::endl;
     std::cout << "  ESC - Exit" << std::endl;
     std::cout << "\n[Info] Mouse is free by default. Press M to lock/unlock mouse.\n" << std::endl;
 
     // 连接烟花系统与光源管理器
     fireworkSystem.setLightManager(&lightManager);
 
+    // 后台预解码图片烟花模板，避免图片烟花首次爆炸时卡顿
+    fireworkSystem.preloadImages({
+        "assets/firework_images/image.png",
+        "assets/firework_images/word.png"
+    });
+
+    // 加载演出用的烟花描述（新增烟花只需编辑该文件）
+    fireworkSystem.loadShells("assets/shells/show.shells");
+
+    // 启动时把演出脚本编译一次到临时目录，按 P 时只需打开时间线
+    std::error_code tempError;
+    std::filesystem::path tempDir = std::filesystem::temp_directory_path(tempError);
+    if (!tempError) {
+        std::string timelinePath = (tempDir / "fireworks_demo.fwshow").string();
+        if (ShowTimeline::compile("assets/shows/demo.show", timelinePath) >= 0) demoTimelinePath = timelinePath;
+    }
+    else {
+        std::cerr << "[Show] No temp directory for the compiled show: " << tempError.message() << std::endl;
+    }
+
     // 测试模式标志
     bool autoTestMode = false;
 
     // std::cout << "Current Context: " << glfwGetCurrentContext() << std::endl;
     postProcessor = new PostProcessor(SCR_WIDTH, SCR_HEIGHT);
 
+    // 自适应画质：按最近的 CPU / GPU 帧时间调节粒子数、拖尾密度、辉光次数和渲染分辨率
+    QualityGovernor qualityGovernor;
+    GpuTimer gpuTimer;
+
     while (!glfwWindowShouldClose(window))
     {
+        double frameStart = glfwGetTime();
+        gpuTimer.begin();
+
+        // 应用当前画质级别（窗口缩放会重建 PostProcessor，因此每帧都设置一次）
+        const QualityGovernor::Level& quality = qualityGovernor.settings();
+        fireworkSystem.particleScale = quality.particleScale;
+        fireworkSystem.tailStride = quality.tailStride;
+        postProcessor->SetBlurPasses(quality.blurPasses);
+        postProcessor->SetRenderScale(quality.resolutionScale);
+        postProcessor->SetParticleResolution(quality.particleResolution);
+        fireworkSystem.pointScale = postProcessor->GetRenderScale() * postProcessor->GetParticleResolution();
+
 		// 所有的场景都将渲染到后处理对象的帧缓冲中
         postProcessor->Bind();
 
@@ -210,6 +284,54 @@ int main()
             fireworkSystem.runTest(currentFrame);
         }
 
+        // 按P键播放启动时编译好的演出，再按一次停止
+        static bool wasKeyPPressed = false;
+        bool isKeyPPressed = (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS);
+        if (isKeyPPressed && !wasKeyPPressed) {
+            if (showPlayer.isPlaying()) {
+                showPlayer.stop();
+                std::cout << "[Show] Stopped at " << showPlayer.time() << " s" << std::endl;
+            }
+            else if (demoTimelinePath.empty()) {
+                std::cout << "[Show] assets/shows/demo.show failed to compile at startup" << std::endl;
+            }
+            else if (showPlayer.open(demoTimelinePath)) {
+                showPlayer.start(fireworkSystem);
+            }
+        }
+        wasKeyPPressed = isKeyPPressed;
+
+        // 按B键切换粒子绘制路径：GL_POINTS / 实例化四边形（可对照两者的 GPU 帧时间）
+        static bool wasKeyBPressed = false;
+        bool isKeyBPressed = (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS);
+        if (isKeyBPressed && !wasKeyBPressed) {
+            fireworkSystem.billboards = !fireworkSystem.billboards;
+            std::cout << "[Firework] Particle path: " << (fireworkSystem.billboards ? "instanced billboards" : "GL_POINTS")
+                      << " (gpu " << qualityGovernor.averageGpuMs() << " ms)" << std::endl;
+        }
+        wasKeyBPressed = isKeyBPressed;
+
+        // 按G键切换爆炸粒子的模拟位置：CPU / GPU 变换反馈（已交给 GPU 的粒子继续在 GPU 上模拟直到消失）
+        static bool wasKeyGPressed = false;
+        bool isKeyGPressed = (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS);
+        if (isKeyGPressed && !wasKeyGPressed) {
+            fireworkSystem.gpuSimulation = !fireworkSystem.gpuSimulation;
+            std::cout << "[Firework] Particle simulation: " << (fireworkSystem.gpuSimulation ? "GPU transform feedback" : "CPU")
+                      << " (cpu " << qualityGovernor.averageCpuMs() << " ms, gpu " << qualityGovernor.averageGpuMs() << " ms)" << std::endl;
+        }
+        wasKeyGPressed = isKeyGPressed;
+
+        // 按N键切换解析爆炸：爆炸粒子生成时上传一次，之后由顶点着色器按时间算位置（开启时优先于 G 的 GPU 模拟）
+        static bool wasKeyNPressed = false;
+        bool isKeyNPressed = (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS);
+        if (isKeyNPressed && !wasKeyNPressed) {
+            fireworkSystem.analyticBursts = !fireworkSystem.analyticBursts;
+            std::cout << "[Firework] Analytic bursts: " << (fireworkSystem.analyticBursts ? "on" : "off")
+                      << " (cpu " << qualityGovernor.averageCpuMs() << " ms, gpu " << qualityGovernor.averageGpuMs() << " ms)" << std::endl;
+        }
+        wasKeyNPressed = isKeyNPressed;
+        showPlayer.update(deltaTime, fireworkSystem);
+
         // 更新光源管理器（移除过期的临时光源）
         lightManager.Update(deltaTime);
         camera.UpdateOrbitMode(deltaTime);
@@ -219,7 +341,8 @@ int main()
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), 
-            (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 200.0f);
+            (float)SCR_WIDTH / (float)SCR_HEIGHT, NEAR_PLANE, FAR_PLANE);
+        postProcessor->SetDepthRange(NEAR_PLANE, FAR_PLANE);
         glm::mat4 view = camera.GetViewMatrix();
 
         // 从管理器获取光源数据
@@ -333,7 +456,10 @@ int main()
         fireworkSystem.setViewProj(view, projection);              
 
         // 渲染烟花粒子系统（在天空盒之后，会正确显示在前面）
+        // 粒子分辨率降低时画进低分辨率缓冲，再按深度上采样合成回场景
+        postProcessor->BeginParticles();
         fireworkSystem.render();
+        postProcessor->EndParticles();
 
 		postProcessor->Unbind();
 		
@@ -350,6 +476,15 @@ int main()
             uiManager->Render(deltaTime);
         }
 
+        // 帧时间统计：CPU 时间不含等待垂直同步，GPU 时间在几帧后才能取到
+        gpuTimer.end();
+        float cpuMs = static_cast<float>((glfwGetTime() - frameStart) * 1000.0);
+        float gpuMs = -1.0f;
+        gpuTimer.poll(gpuMs);
+        if (qualityGovernor.update(deltaTime, cpuMs, gpuMs) && uiManager) {
+            uiManager->SetQualityLevel(qualityGovernor.level(), qualityGovernor.levelCount());
+        }
+
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
@@ -378,6 +513,7 @@ int main()
         
         // 清理其他 OpenGL 资源
         fireworkSystem.cleanupGL();
+        gpuTimer.cleanupGL();
         skybox.cleanup();
         ground.cleanup();
 
@@ -0,0 +1,114 @@
+﻿#include "AnalyticBurstSystem.h"
+#include <algorithm>
+#include <iostream>
+
+AnalyticBurstSystem::AnalyticBurstSystem(size_t capacity)
+    : maxParticles((std::max)(capacity, size_t(1))) {
+}
+
+AnalyticBurstSystem::~AnalyticBurstSystem() {
+    cleanupGL();
+}
+
+void AnalyticBurstSystem::spawn(const glm::vec3& origin, const glm::vec3& velocity, float life, const glm::vec4& color,
+    float size, float angle, float spin, float ramp, double birthTime) {
+    // 缓冲内的粒子已全部死亡：从头开始使用，并把时间基准移到现在
+    if (usedSlots > 0 && pending.empty() && birthTime >= lastDeath) {
+        usedSlots = 0;
+        head = 0;
+    }
+    if (usedSlots == 0 && pending.empty()) epoch = birthTime;
+
+    lastDeath = (std::max)(lastDeath, birthTime + life);
+    pending.push_back({ glm::vec4(origin, static_cast<float>(birthTime - epoch)),
+        glm::vec4(velocity, life),
+        color,
+        glm::vec4(size, angle, spin, ramp) });
+}
+
+void AnalyticBurstSystem::initGL() {
+    if (glInited) return;
+
+    shader = new Shader("assets/shaders/particle_analytic.vs", "assets/shaders/firework.fs");
+
+    // 缓冲一次分配到位，之后只写入新粒子所在的槽位
+    glGenBuffers(1, &vbo);
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, maxParticles * sizeof(Particle), nullptr, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, originBirth));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, velLife));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, params));
+    glEnableVertexAttribArray(3);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::cout << "[AnalyticBursts] Particle buffer: " << maxParticles << " particles ("
+              << (maxParticles * sizeof(Particle)) / (1024 * 1024) << " MB)" << std::endl;
+    glInited = true;
+}
+
+// 把新粒子写入环形位置（超出容量时只保留最新的部分）；这是这些粒子唯一的一次上传
+void AnalyticBurstSystem::uploadPending() {
+    if (pending.empty()) return;
+
+    const Particle* src = pending.data();
+    size_t n = pending.size();
+    if (n > maxParticles) {
+        src += n - maxParticles;
+        n = maxParticles;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    size_t first = (std::min)(n, maxParticles - head);
+    glBufferSubData(GL_ARRAY_BUFFER, head * sizeof(Particle), first * sizeof(Particle), src);
+    if (n > first) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (n - first) * sizeof(Particle), src + first);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    head = (head + n) % maxParticles;
+    usedSlots = (std::min)(usedSlots + n, maxParticles);
+    pending.clear();
+}
+
+void AnalyticBurstSystem::render(const glm::mat4& view, const glm::mat4& projection, double time, float gravity, float dragRate, float pointScale) {
+    if (!glInited) initGL();
+    uploadPending();
+    if (usedSlots == 0 || time >= lastDeath) return;
+
+    shader->use();
+    shader->setMat4("view", view);
+    shader->setMat4("projection", projection);
+    shader->setFloat("pointScale", pointScale);
+    shader->setFloat("time", static_cast<float>(time - epoch));
+    shader->setFloat("gravity", gravity);
+    shader->setFloat("dragRate", dragRate);
+    shader->setInt("colorRamp", 0);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)usedSlots);
+    glBindVertexArray(0);
+}
+
+void AnalyticBurstSystem::cleanupGL() {
+    if (!glInited) return;
+
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    vbo = 0;
+    vao = 0;
+    if (shader) {
+        delete shader;
+        shader = nullptr;
+    }
+    usedSlots = 0;
+    head = 0;
+    lastDeath = 0.0;
+    pending.clear();
+    glInited = false;
+}
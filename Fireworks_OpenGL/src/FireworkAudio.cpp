@@ -0,0 +1,56 @@
+﻿#include "FireworkAudio.h"
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+FireworkAudio::FireworkAudio()
+    : variantRandom(std::random_device{}()) {
+    for (int i = 0; i < 2; ++i) {
+        risePaths[i] = "assets/sounds/firework/rise/firework_rise_0" + std::to_string(i + 1) + ".wav";
+        explosionPaths[i] = "assets/sounds/firework/explosion/firework_explosion_0" + std::to_string(i + 1) + ".wav";
+    }
+
+    // 初始化音频引擎
+    ma_result result = ma_engine_init(NULL, &audioEngine);
+    if (result == MA_SUCCESS) {
+        audioInitialized = true;
+        std::cout << "Audio engine initialized\n";
+    }
+    else {
+        std::cerr << "Audio init failed: " << ma_result_description(result) << "\n";
+    }
+}
+
+FireworkAudio::~FireworkAudio() {
+    if (audioInitialized) {
+        ma_engine_uninit(&audioEngine);
+    }
+}
+
+// 播放 count 个声音，每个从两个变体中随机选一个
+void FireworkAudio::playVariants(const std::string (&variants)[2], int count) {
+    for (int i = 0; i < count; ++i) {
+        int index = static_cast<int>(variantRandom.next() >> 31); // 取最高位（xoshiro128+ 的低位质量较差）
+        ma_engine_play_sound(&audioEngine, variants[index].c_str(), NULL);
+    }
+}
+
+void FireworkAudio::onLaunch(const glm::vec3& position, FireworkType type) {
+    // 升空音效（flush 时播放）
+    pendingRises++;
+}
+
+void FireworkAudio::onExplosion(const glm::vec3& position, FireworkType type, const glm::vec4& color, bool isSecondary) {
+    // 主爆炸音效（flush 时播放）
+    if (!isSecondary) pendingExplosions++;
+}
+
+void FireworkAudio::flush() {
+    if (audioInitialized) {
+        int voices = (std::max)(maxVoicesPerFlush, 1);
+        playVariants(risePaths, (std::min)(pendingRises, voices));
+        playVariants(explosionPaths, (std::min)(pendingExplosions, voices));
+    }
+    pendingRises = 0;
+    pendingExplosions = 0;
+}
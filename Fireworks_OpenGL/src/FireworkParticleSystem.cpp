@@ -1,43 +1,19 @@
 #include "FireworkParticleSystem.h"
-#include "miniaudio.h"
-#include "stb_image.h"
-#include <glm/gtc/matrix_transform.hpp>
-#include <random>
-#include <algorithm>
-#include <glad/glad.h>
 #include <iostream>
 #include <cmath>
-#include <ctime>   // 用于time()函数
-#include <cstdlib> // 用于rand()和srand()函数
-// 随机数生成器
-static std::random_device rd;
-static std::mt19937 gen(rd());
-static std::uniform_real_distribution<float> dis(0.0f, 1.0f);
-
-extern glm::vec4 HSVtoRGB(float h, float s, float v);
 
 FireworkParticleSystem::FireworkParticleSystem() {
     vao = 0;
-    vbo = 0;
     glInited = false;
     shader = nullptr;
     lightManager = nullptr;
-    // 初始化音频引擎
-    ma_result result = ma_engine_init(NULL, &audioEngine);
-    if (result == MA_SUCCESS) {
-        audioInitialized = true;
-        std::cout << "Audio engine initialized\n";
-    }
-    else {
-        std::cerr << "Audio init failed: " << ma_result_description(result) << "\n";
-    }
+    // 音效和光源作为事件接收者挂到模拟上
+    addEventSink(&audio);
+    addEventSink(this);
 }
 
 FireworkParticleSystem::~FireworkParticleSystem() {
     cleanupGL();
-    if (audioInitialized) {
-        ma_engine_uninit(&audioEngine);
-    }
 }
 
 void FireworkParticleSystem::initGL() {
@@ -47,710 +23,422 @@ void FireworkParticleSystem::initGL() {
     if (!shader) {
         shader = new Shader("assets/shaders/firework.vs", "assets/shaders/firework.fs");
     }
+    if (!billboardShader) {
+        billboardShader = new Shader("assets/shaders/particle_billboard.vs", "assets/shaders/particle_billboard.fs");
+    }
+    if (!trailShader) {
+        trailShader = new Shader("assets/shaders/particle_trail.vs", "assets/shaders/particle_trail.fs");
+    }
+
+    // 顶点流缓冲：每帧映射一段直接写入紧凑顶点，不经过中间数组
+    stream.initGL(4096 * sizeof(PackedParticleVertex));
+    trailStream.initGL(4096 * sizeof(PackedTrailSegment));
 
     glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
     glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, position));
+    glBindBuffer(GL_ARRAY_BUFFER, stream.buffer());
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedParticleVertex), (void*)offsetof(PackedParticleVertex, x));
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, color));
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(PackedParticleVertex), (void*)offsetof(PackedParticleVertex, colorSize));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, size));
+    glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(PackedParticleVertex), (void*)offsetof(PackedParticleVertex, ageRamp));
     glEnableVertexAttribArray(2);
     glBindVertexArray(0);
+
+    // 实例化四边形路径：四个角共用一个静态缓冲，每实例属性的偏移在绘制时设置
+    const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+    glGenBuffers(1, &quadVbo);
+    glGenVertexArrays(1, &billboardVao);
+    glBindVertexArray(billboardVao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    for (GLuint attribute = 1; attribute <= 4; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+
+    // 拖尾段同样是实例化四边形：共用四个角，每实例属性（两端位置、颜色尺寸、参数）在绘制时设置偏移
+    glGenVertexArrays(1, &trailVao);
+    glBindVertexArray(trailVao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    for (GLuint attribute = 1; attribute <= 4; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+
+    glGenTextures(1, &rampTexture);
+    glBindTexture(GL_TEXTURE_2D, rampTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
     glInited = true;
 }
 
+// 烟花描述中的渐变有增改时重新烘焙（渐变数量很少，整张纹理重传）
+void FireworkParticleSystem::updateRampTexture() {
+    const ShellCatalog& catalog = shellCatalog();
+    if (catalog.rampRevision() == rampRevision) return;
+    rampRevision = catalog.rampRevision();
+
+    std::vector<glm::vec4> table = catalog.bakeRamps(RAMP_WIDTH);
+    GLsizei rows = static_cast<GLsizei>(catalog.rampCount());
+    glBindTexture(GL_TEXTURE_2D, rampTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, RAMP_WIDTH, rows, 0, GL_RGBA, GL_FLOAT, table.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    std::cout << "[Firework] Color ramps: " << rows << std::endl;
+}
+
 void FireworkParticleSystem::setLightManager(PointLightManager* manager) {
     lightManager = manager;
 }
 
-void FireworkParticleSystem::launch(const glm::vec3& position, FireworkType type, float life,
-    const glm::vec4& primaryColor, const glm::vec4& secondaryColor, float size) {
-    // 播放升空音效
-    if (audioInitialized) {
-        int index = static_cast<int>(dis(gen) * 2) % 2;
-        std::string path = "assets/sounds/firework/rise/firework_rise_0" + std::to_string(index + 1) + ".wav";
-        ma_engine_play_sound(&audioEngine, path.c_str(), NULL);
-    }
-
-    float randomExplosionHeight = 3.0f + dis(gen) * 4.0f;
-
-    glm::vec3 fixedVelocity(0.0f, 12.0f, 0.0f);
-    Particle p;
-    float scale = 10.0;
+void FireworkParticleSystem::update(float deltaTime) {
+    setHandOff(gpuSimulation || analyticBursts ? this : nullptr);
+    FireworkSimulation::update(deltaTime);
 
-    // 随机位置（x在-8到8之间，z在-5到5之间）
-    glm::vec3 randomPos = position;
-    if (position == glm::vec3(0.0f, 0.5f, 0.0f)) {
-        randomPos.x = (dis(gen) * 16.0f) - 8.0f;  // -8到8
-        randomPos.z = (dis(gen) * 10.0f) - 5.0f;  // -5到5
+    // 关闭 GPU 模式后，已在 GPU 上的粒子继续模拟直到自然消失；与 CPU 模拟使用相同的固定步长
+    if (gpuParticles) {
+        for (int i = 0; i < lastSubSteps(); ++i) gpuParticles->simulate(stepDelta(), gravity, stepDrag());
     }
 
-    p.position = randomPos;
-    p.velocity = fixedVelocity;
-    p.color = primaryColor * scale;
-    p.initialColor = primaryColor;
-    p.secondaryColor = secondaryColor;
-    p.life = life * (0.6f + dis(gen) * 0.2f);  // 随机寿命，让爆炸高度随机
-    p.maxLife = p.life;
-    p.size = size * 2.5f;  // 🔧 增大升空粒子大小（原本是 size，现在是 2.5 倍）
-    p.type = type;
-    p.isTail = false;
-    p.canExplodeAgain = false;
-    p.isDualColor = (secondaryColor != glm::vec4(1.0f));  // 如果是默认值，则是单色
-    p.rotationAngle = 0.0f;
-    p.imagePath = "";  // 默认空路径
-
-    launcherParticles.push_back(p);
+    // 本帧（包括两次 update 之间的发射）累积的音效和闪光一次提交
+    audio.flush();
+    flushLights();
 }
 
-void FireworkParticleSystem::update(float deltaTime) {
-    float dt = deltaTime * timeScale;
-    
-    // Lambda: 创建拖尾粒子（合并重复逻辑）
-    auto createTail = [&](const Particle& parent, const glm::vec3& position) {
-        Particle tail = parent;
-        tail.position = position;
-        tail.isTail = true;
-        tail.life = tailLife;
-        tail.maxLife = tailLife;
-        tail.velocity = glm::vec3(0.0f);
-        tail.color.a *= tailAlpha;
-        tail.initialColor.a *= tailAlpha;
-        tailParticles.push_back(tail);
-    };
-
-    // 1. 更新上升粒子
-    std::vector<Particle> toExplode;
-    for (auto& p : launcherParticles) {
-        if (p.life > 0.0f) {
-            glm::vec3 prevPos = p.position;
-            p.position += p.velocity * dt;
-            p.velocity += glm::vec3(0, gravity, 0) * dt;
-            p.life -= dt;
-            p.color = calculateColorGradient(p);
-            
-            if (!p.isTail) createTail(p, prevPos);
+// 把块中的存活粒子追加到解析粒子缓冲或 GPU 粒子缓冲
+void FireworkParticleSystem::takeParticles(const ParticleChunk& c, float spin) {
+    if (analyticBursts) {
+        // 接管时粒子还在爆炸中心、尚未积分，出生时间为本步开始的时刻
+        if (!analyticParticles) analyticParticles = std::make_unique<AnalyticBurstSystem>(analyticParticleCapacity);
+        double birth = simulationTime();
+        float ramp = static_cast<float>(chunkRamp(c));
+        for (int i = 0; i < c.count; ++i) {
+            if (c.life[i] <= 0.0f) continue;
+            analyticParticles->spawn(glm::vec3(c.posX[i], c.posY[i], c.posZ[i]), glm::vec3(c.velX[i], c.velY[i], c.velZ[i]),
+                c.life[i], c.baseColor[i], c.sizes[i], c.rotation[i], spin, ramp, birth);
         }
+        return;
+    }
 
-        if (p.velocity.y <= 0.0f || p.life <= 0.0f) {
-            toExplode.push_back(p);
-        }
+    if (!gpuParticles) gpuParticles = std::make_unique<GpuParticleSystem>(gpuParticleCapacity);
+
+    // update 结束后 GPU 按本帧的子步数连续推进；第 k 个子步生成的粒子跳过前 k 次，只从出生的子步开始模拟
+    int delaySteps = currentStepIndex();
+    float ramp = static_cast<float>(chunkRamp(c));
+    for (int i = 0; i < c.count; ++i) {
+        if (c.life[i] <= 0.0f) continue;
+        gpuParticles->spawn({ glm::vec4(c.posX[i], c.posY[i], c.posZ[i], c.life[i]),
+            glm::vec4(c.velX[i], c.velY[i], c.velZ[i], c.maxLife[i]),
+            c.baseColor[i],
+            glm::vec4(c.sizes[i], c.rotation[i], spin, ramp) }, delaySteps);
     }
+}
 
-    for (const auto& p : toExplode) {
-        createExplosion(p, false);
+// 仅第一次爆炸添加光源：先并入附近的待添加闪光，帧末统一添加
+void FireworkParticleSystem::onExplosion(const glm::vec3& position, FireworkType type, const glm::vec4& color, bool isSecondary) {
+    if (!lightManager || isSecondary) return;
+
+    // 使用烟花的初始颜色（鲜艳）
+    glm::vec3 lightColor(color.r, color.g, color.b);
+    for (LightFlash& flash : pendingFlashes) {
+        if (glm::distance(flash.position, position) < lightMergeDistance) {
+            flash.count++;
+            flash.position += (position - flash.position) / static_cast<float>(flash.count);
+            flash.color += lightColor;
+            return;
+        }
     }
+    pendingFlashes.push_back({ position, lightColor, 1 });
+}
 
-    // 2. 更新爆炸粒子
-    std::vector<Particle> toExplodeAgain;
-    for (auto& p : explosionParticles) {
-        if (p.life > 0.0f) {
-            glm::vec3 prevPos = p.position;
-            
-            // 螺旋烟花旋转
-            if (p.type == FireworkType::Spiral) {
-                p.rotationAngle += dt * 3.0f;
-                float radius = glm::length(glm::vec2(p.velocity.x, p.velocity.z));
-                p.velocity.x = radius * cos(p.rotationAngle);
-                p.velocity.z = radius * sin(p.rotationAngle);
-            }
-            
-            p.position += p.velocity * dt;
-            p.velocity += glm::vec3(0, gravity, 0) * dt;
-			p.velocity *= 0.993f; // 空气阻力
-            p.life -= dt;
-			// if (p.type != FireworkType::Image)
-            p.color = calculateColorGradient(p);
-            
-
-            if (!p.isTail) createTail(p, prevPos);
+// 每组闪光两个光源，持续0.1秒
+void FireworkParticleSystem::flushLights() {
+    if (lightManager) {
+        for (const LightFlash& flash : pendingFlashes) {
+            glm::vec3 lightColor = flash.color / static_cast<float>(flash.count);
+            float boost = std::sqrt(static_cast<float>(flash.count));
+
+            // 主光源
+            lightManager->AddTemporaryLight(flash.position, lightColor, 25.0f * boost, 0.1f);
+
+            // 中心光球效果：更强的光
+            lightManager->AddTemporaryLight(flash.position, lightColor * 1.5f, 40.0f * boost, 0.1f);
         }
     }
+    pendingFlashes.clear();
+}
 
-    // 3. 更新延迟爆炸事件
-    for (auto& delayed : delayedExplosions) {
-        delayed.timer -= dt;
-        if (delayed.timer <= 0.0f) {
-            // 触发第二次爆炸，根据类型生成相同形状但范围更大的爆炸
-            int count = 90; // 第二次爆炸粒子数
-            switch (delayed.type) {
-            case FireworkType::Sphere:
-                generateSphereParticles(delayed.position, delayed.color, count, delayed.radius, false);
-                break;
-            case FireworkType::Ring:
-                generateRingParticles(delayed.position, delayed.color, count, delayed.radius);
-                break;
-            case FireworkType::MultiLayer:
-                generateMultiLayerParticles(delayed.position, delayed.color, count, delayed.radius);
-                break;
-            case FireworkType::Spiral:
-                generateSpiralParticles(delayed.position, delayed.color, count, delayed.radius);
-                break;
-            case FireworkType::Heart:
-                //generateHeartParticles(delayed.position, delayed.color, count, delayed.radius);
-                break;
+// 拖尾覆盖 tailLife 的模拟时间：采样 k 距头部 (age(k) + alpha) 步，在拖尾上的位置 t = 年龄 / tailLife。
+// 采样按屏幕位移记录、间隔不固定，末端取在跨过 t = 1 的两个采样之间，拖尾长度恒定，
+// 随插值连续移动而不是每次记录时跳一格（慢的粒子采样很少，拖尾只剩头部到第一个采样之间的一小段）
+size_t FireworkParticleSystem::writeTrails(PackedTrailSegment* out, float alpha) const {
+    const float dt = stepDelta();
+    if (dt <= 0.0f || tailLife <= 0.0f) return 0;
+    const float span = tailLife / dt; // 拖尾覆盖的步数
+    size_t written = 0;
+
+    // 一个粒子的拖尾：head 为插值后的位置，sample(k) 为第 k 新的采样
+    auto emit = [&](const glm::vec3& head, int filled, const TrailRing& ring, auto sample,
+                    const glm::vec4& color, float size, float age, uint32_t ramp) {
+        glm::vec3 from = head;
+        float t0 = 0.0f;
+        for (int k = 0; k < filled; ++k) {
+            glm::vec3 to = sample(k);
+            float t1 = (static_cast<float>(ring.age(k)) + alpha) / span;
+            if (t1 >= 1.0f) {
+                to = glm::mix(from, to, (1.0f - t0) / (t1 - t0));
+                t1 = 1.0f;
             }
-            // 第二次爆炸不添加光源
+            out[written++] = PackedTrailSegment::pack(from, to, color, size, age, ramp, t0, t1);
+            if (t1 >= 1.0f) break;
+            from = to;
+            t0 = t1;
         }
-    }
-    
-    // 移除已触发的延迟爆炸
-    delayedExplosions.erase(
-        std::remove_if(delayedExplosions.begin(), delayedExplosions.end(),
-            [](const DelayedExplosion& d) { return d.timer <= 0.0f; }),
-        delayedExplosions.end()
-    );
-
-    // 4. 更新拖尾粒子
-    for (auto& tail : tailParticles) {
-        if (tail.life > 0.0f) {
-            float t = 1.0f - (tail.life / tail.maxLife);
-            tail.size = (std::max)(0.01f, tail.size * (1.0f - t * 0.05f));
-            tail.life -= dt;
-            tail.color = calculateColorGradient(tail);
+    };
+
+    const ParticleStore& L = launchers();
+    for (size_t i = 0, n = L.count(); i < n; ++i) {
+        glm::vec3 prev = L.previousPosition(i);
+        glm::vec3 head = prev + (L.position(i) - prev) * alpha;
+        emit(head, L.trailFilled[i], L.trail, [&](int k) { return L.trailPosition(i, L.trail.slot(k)); },
+             L.baseColor[i], L.sizes[i], 1.0f - L.life[i] / L.maxLife[i], 0);
+    }
+
+    const int stride = (std::max)(tailStride, 1);
+    for (const ParticleChunk* chunk : explosions().active) {
+        const ParticleChunk& c = *chunk;
+        if (c.trail.filled == 0 || !chunkVisible(c)) continue;
+        uint32_t ramp = chunkRamp(c);
+        for (int i = 0; i < c.count; i += stride) {
+            if (c.life[i] <= 0.0f) continue;
+            glm::vec3 head(c.prevX[i] + (c.posX[i] - c.prevX[i]) * alpha,
+                           c.prevY[i] + (c.posY[i] - c.prevY[i]) * alpha,
+                           c.prevZ[i] + (c.posZ[i] - c.prevZ[i]) * alpha);
+            emit(head, c.trail.filled, c.trail, [&](int k) {
+                int s = c.trail.slot(k);
+                return glm::vec3(c.trailX[s][i], c.trailY[s][i], c.trailZ[s][i]);
+            }, c.baseColor[i], c.sizes[i], 1.0f - c.life[i] / c.maxLife[i], ramp);
         }
     }
-
-    // 移除死亡粒子（合并条件）
-    auto isDead = [](const Particle& p) { return p.life <= 0.0f || p.position.y < 0.0f; };
-    launcherParticles.erase(std::remove_if(launcherParticles.begin(), launcherParticles.end(), isDead), launcherParticles.end());
-    explosionParticles.erase(std::remove_if(explosionParticles.begin(), explosionParticles.end(), isDead), explosionParticles.end());
-    tailParticles.erase(std::remove_if(tailParticles.begin(), tailParticles.end(), isDead), tailParticles.end());
+    return written;
 }
 
 void FireworkParticleSystem::render() {
     if (!glInited) initGL();
 
-    // 合并所有粒子到 particles 用于渲染
-    particles.clear();
-    particles.insert(particles.end(), launcherParticles.begin(), launcherParticles.end());
-    particles.insert(particles.end(), explosionParticles.begin(), explosionParticles.end());
-    particles.insert(particles.end(), tailParticles.begin(), tailParticles.end());
-
-    if (particles.empty() || !shader) return;
-
-    shader->use();
-    shader->setMat4("view", viewMatrix);
-    shader->setMat4("projection", projMatrix);
+    // 所有粒子直接写入流缓冲的映射区域：颜色只写初始颜色，随寿命的变化由着色器按年龄查颜色渐变表
+    // 位置在最近两个模拟步之间插值，渲染帧率高于模拟频率时运动依然平滑
+    const float alpha = interpolationAlpha();
+    const ParticleStore& L = launchers();
+    size_t maxVertices = L.count() + explosions().slotCount();
+    bool drawGpu = gpuParticles && gpuParticles->activeSlots() > 0;
+    if ((maxVertices == 0 && !drawGpu && !analyticParticles) || !shader) return;
+
+    // 点精灵路径每粒子 20 字节；四边形路径附加最近一步的位移（拉长用），每粒子 32 字节
+    const size_t vertexBytes = billboards ? sizeof(PackedBillboardVertex) : sizeof(PackedParticleVertex);
+    size_t written = 0;
+    size_t offset = 0;
+    bool uploaded = false;
+    if (maxVertices > 0) {
+        void* mapped = stream.map(maxVertices * vertexBytes, offset);
+        if (mapped) {
+            auto fill = [&](auto* out) {
+                for (size_t i = 0, n = L.count(); i < n; ++i) {
+                    glm::vec3 prev = L.previousPosition(i);
+                    glm::vec3 motion = L.position(i) - prev;
+                    packVertex(out[written++], prev + motion * alpha, motion, L.baseColor[i], L.sizes[i], 1.0f - L.life[i] / L.maxLife[i], 0);
+                }
+                auto gather = [&](const ParticleChunkPool& pool) {
+                    alignas(32) float age[ParticleChunk::CAPACITY];
+                    for (const ParticleChunk* chunk : pool.active) {
+                        const ParticleChunk& c = *chunk;
+                        if (!chunkVisible(c)) continue; // 所属爆发完全在视锥体外
+                        ParticleKernels::normalizedAge(simdLevel, c.life, c.maxLife, age, c.count); // 整块一次算出归一化年龄
+                        uint32_t ramp = chunkRamp(c);
+                        for (int i = 0; i < c.count; ++i) {
+                            if (c.life[i] <= 0.0f) continue; // 块内已死亡的粒子
+                            glm::vec3 motion(c.posX[i] - c.prevX[i], c.posY[i] - c.prevY[i], c.posZ[i] - c.prevZ[i]);
+                            glm::vec3 position(c.prevX[i] + motion.x * alpha, c.prevY[i] + motion.y * alpha, c.prevZ[i] + motion.z * alpha);
+                            packVertex(out[written++], position, motion, c.baseColor[i], c.sizes[i], age[i], ramp);
+                        }
+                    }
+                };
+                gather(explosions());
+            };
+            if (billboards) fill(static_cast<PackedBillboardVertex*>(mapped));
+            else fill(static_cast<PackedParticleVertex*>(mapped));
+            uploaded = stream.unmap(written * vertexBytes);
+        }
+    }
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, particles.size() * sizeof(Particle), particles.data(), GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glEnableVertexAttribArray(2);
+    // 视口大小：四边形 / 拖尾按像素展开；高度同时记下来，下一次 setViewProj 据此换算拖尾采样的屏幕缩放
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    viewportHeight = static_cast<float>(viewport[3]);
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA); // 标准alpha混合，避免叠加变色
     glEnable(GL_PROGRAM_POINT_SIZE);
     glDepthMask(GL_FALSE); // 关闭深度写入，但保留深度测试
 
-    glDrawArrays(GL_POINTS, 0, (GLsizei)particles.size());
+    // 所有粒子路径的着色器都从纹理单元 0 读取颜色渐变表
+    updateRampTexture();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, rampTexture);
+
+    // 拖尾画在粒子之前：段数上限 = 每个可能带拖尾的粒子 SAMPLES 段
+    size_t maxSegments = (L.count() + explosions().slotCount() / (std::max)(tailStride, 1) + explosions().active.size()) * TrailRing::SAMPLES;
+    if (maxVertices > 0 && trailShader) {
+        size_t trailOffset = 0;
+        size_t segments = 0;
+        bool trailsUploaded = false;
+        void* mapped = trailStream.map(maxSegments * sizeof(PackedTrailSegment), trailOffset);
+        if (mapped) {
+            segments = writeTrails(static_cast<PackedTrailSegment*>(mapped), alpha);
+            trailsUploaded = trailStream.unmap(segments * sizeof(PackedTrailSegment));
+        }
+        if (trailsUploaded && segments > 0) {
+            trailShader->use();
+            trailShader->setMat4("view", viewMatrix);
+            trailShader->setMat4("projection", projMatrix);
+            trailShader->setFloat("pointScale", pointScale);
+            trailShader->setVec2("viewportSize", glm::vec2(viewport[2], viewport[3]));
+            trailShader->setFloat("minPixelSize", minPixelSize);
+            trailShader->setFloat("maxPixelSize", maxPixelSize);
+            trailShader->setFloat("tailAlpha", tailAlpha);
+            trailShader->setInt("colorRamp", 0);
+
+            glBindVertexArray(trailVao);
+            glBindBuffer(GL_ARRAY_BUFFER, trailStream.buffer());
+            const size_t stride = sizeof(PackedTrailSegment);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(trailOffset + offsetof(PackedTrailSegment, x0)));
+            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(trailOffset + offsetof(PackedTrailSegment, x1)));
+            glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(trailOffset + offsetof(PackedTrailSegment, colorSize)));
+            glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(trailOffset + offsetof(PackedTrailSegment, params)));
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)segments);
+        }
+    }
+
+    if (uploaded && written > 0 && billboards) {
+        // 实例化四边形：每实例属性从本帧写入的位置开始读（GL 3.3 没有 baseInstance，直接改属性偏移）
+        billboardShader->use();
+        billboardShader->setMat4("view", viewMatrix);
+        billboardShader->setMat4("projection", projMatrix);
+        billboardShader->setFloat("pointScale", pointScale);
+        billboardShader->setVec2("viewportSize", glm::vec2(viewport[2], viewport[3]));
+        billboardShader->setFloat("minPixelSize", minPixelSize);
+        billboardShader->setFloat("maxPixelSize", maxPixelSize);
+        billboardShader->setFloat("stretch", velocityStretch);
+        billboardShader->setFloat("maxStretchPixels", maxStretchPixels);
+        billboardShader->setInt("colorRamp", 0);
+
+        glBindVertexArray(billboardVao);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.buffer());
+        const size_t stride = sizeof(PackedBillboardVertex);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(PackedParticleVertex, x)));
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(offset + offsetof(PackedParticleVertex, colorSize)));
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(PackedBillboardVertex, motionX)));
+        glVertexAttribPointer(4, 2, GL_UNSIGNED_SHORT, GL_FALSE, stride, (void*)(offset + offsetof(PackedParticleVertex, ageRamp)));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)written);
+    }
+    else if (uploaded && written > 0) {
+        shader->use();
+        shader->setMat4("view", viewMatrix);
+        shader->setMat4("projection", projMatrix);
+        shader->setFloat("pointScale", pointScale);
+        shader->setInt("colorRamp", 0);
+
+        // 流缓冲的映射偏移按 64 字节对齐，不一定是 20 字节顶点的整数倍：同样改属性偏移，从 0 开始绘制
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.buffer());
+        const size_t stride = sizeof(PackedParticleVertex);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset + offsetof(PackedParticleVertex, x)));
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(offset + offsetof(PackedParticleVertex, colorSize)));
+        glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_FALSE, stride, (void*)(offset + offsetof(PackedParticleVertex, ageRamp)));
+        glDrawArrays(GL_POINTS, 0, (GLsizei)written);
+    }
+
+    // GPU 模拟的粒子直接从变换反馈缓冲绘制
+    if (drawGpu) gpuParticles->render(viewMatrix, projMatrix, pointScale);
+
+    // 解析粒子：时间与其他粒子的渲染插值对齐（落后最近一步 (1 - alpha) 步）；
+    // 每步速度乘以 stepDrag，换算成连续的指数衰减率
+    if (analyticParticles) {
+        float dt = stepDelta();
+        double time = simulationTime() - (1.0f - alpha) * dt;
+        float dragRate = dt > 0.0f ? -std::log(stepDrag()) / dt : 0.0f;
+        analyticParticles->render(viewMatrix, projMatrix, time, gravity, dragRate, pointScale);
+    }
 
     glDepthMask(GL_TRUE);
     glDisable(GL_PROGRAM_POINT_SIZE);
     glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
     glDisable(GL_BLEND);
 }
 
 void FireworkParticleSystem::setViewProj(const glm::mat4& view, const glm::mat4& proj) {
     viewMatrix = view;
     projMatrix = proj;
-}
-
-// 颜色渐变计算：初始亮 → 中段彩色 → 消失
-glm::vec4 FireworkParticleSystem::calculateColorGradient(const Particle& p) const {
-    float lifeRatio = p.life / p.maxLife;
-    glm::vec4 resultColor = p.initialColor;
-
-    if (lifeRatio > 0.95f) {
-        // 初始阶段：稍微明亮（缩短到只有最开始5%的时间）
-//         float brightness = 1.0f; // 最多增强到1.15倍
-//         resultColor = glm::vec4(
-//             (glm::min)(p.initialColor.r * brightness, 1.0f), 
-//             (glm::min)(p.initialColor.g * brightness, 1.0f), 
-//             (glm::min)(p.initialColor.b * brightness, 1.0f), 
-//             1.0f
-//         );
-        resultColor = glm::vec4(p.initialColor.r, p.initialColor.g, p.initialColor.b, 1.0f);
-    }
-    else if (lifeRatio > 0.15f) {
-        // 中段：保持原色明亮（延长保持原色的时间）
-        resultColor = glm::vec4(p.initialColor.r, p.initialColor.g, p.initialColor.b, 1.0f);
-    }
-    else {
-        // 末段：快速淡出（只在最后15%生命值时）
-        float fadeRatio = lifeRatio / 0.15f;
-        resultColor = glm::vec4(p.initialColor.r*fadeRatio, p.initialColor.g*fadeRatio, p.initialColor.b*fadeRatio, 1.0f);
-    }
-
-    return resultColor;
-}
-
-// 创建爆炸粒子
-void FireworkParticleSystem::createExplosion(const Particle& source, bool isSecondary) {
-    int count = isSecondary ? 90 : 150; // 第一次爆炸粒子，第二次更多
-
-    // 主爆炸播放音效
-    if (audioInitialized && !isSecondary) {
-        int index = static_cast<int>(dis(gen) * 2) % 2;
-        std::string path = "assets/sounds/firework/explosion/firework_explosion_0" + std::to_string(index + 1) + ".wav";
-        ma_engine_play_sound(&audioEngine, path.c_str(), NULL);
-    }
-    // 仅第一次爆炸添加光源，持续0.1秒
-    if (lightManager && !isSecondary) {
-        // 使用烟花的初始颜色（鲜艳）
-        glm::vec3 lightColor(source.initialColor.r, source.initialColor.g, source.initialColor.b);
-        
-        // 主光源：0.1秒持续时间
-        lightManager->AddTemporaryLight(source.position, lightColor, 25.0f, 0.1f);
-        
-        // 中心光球效果：更强的光，0.1秒
-        lightManager->AddTemporaryLight(source.position, lightColor * 1.5f, 40.0f, 0.1f);
-    }
-
-    // Use initialColor instead of current color to keep explosions bright
-    // 🔧 图片烟花不进行二次爆炸，避免消失时突然发亮
-    if (!isSecondary && source.type != FireworkType::Image) {
-        // 添加延迟0.1秒的第二次爆炸
-        DelayedExplosion delayed;
-        delayed.position = source.position;
-
-        // 双色烟花使用secondaryColor，单色烟花使用initialColor
-        if (source.isDualColor) {
-            delayed.color = source.secondaryColor;
-        }
-        else {
-            delayed.color = source.initialColor;
-        }
-
-        delayed.type = source.type;
-        delayed.timer = 0.1f;
-        delayed.radius = 5.0f; // 第二次爆炸范围更大
-        delayedExplosions.push_back(delayed);
-    }
-    
-    switch (source.type) {
-    case FireworkType::Sphere:
-        generateSphereParticles(source.position, source.initialColor, count);
-        break;
-    case FireworkType::Ring:
-        generateRingParticles(source.position, source.initialColor, count);
-        break;
-    case FireworkType::MultiLayer:
-        generateMultiLayerParticles(source.position, source.initialColor, count);
-        break;
-    case FireworkType::Spiral:
-        generateSpiralParticles(source.position, source.initialColor, count);
-        break;
-    case FireworkType::Heart:
-        generateHeartParticles(source.position, source.initialColor, count);
-        break;
-    case FireworkType::Image:
-        // 图片烟花使用动态路径（从粒子中获取）
-        if (!source.imagePath.empty()) {
-            generateImageParticles(source.position, source.imagePath, 1);
-        } else {
-            // 回退到默认路径
-            generateImageParticles(source.position, "assets/firework_images/image.png", 1);
-        }
-        break;
-    }
-}
-
-// 球形烟花 - 🔧 缩短生命周期
-void FireworkParticleSystem::generateSphereParticles(const glm::vec3& center, const glm::vec4& color, int count, float radius, bool canExplode) {
-    for (int i = 0; i < count; ++i) {
-        float u = dis(gen);
-        float v = dis(gen);
-        float theta = u * 2.0f * 3.14159265f;
-        float phi = acos(2.0f * v - 1.0f);
-        float r = radius * (1.5f + 0.15f * dis(gen)); // 半径有一定随机性
-
-        Particle p;
-        p.position = center;
-        p.velocity = glm::vec3(
-            sin(phi) * cos(theta),
-            sin(phi) * sin(theta),
-            cos(phi)
-        ) * r * 2.0f;
-        p.color = color;
-        p.initialColor = color;
-		// 调整生命周期（0.4-0.55s）
-        p.life = 0.4f + 0.15f * dis(gen);
-        p.maxLife = p.life;
-        p.size = childSize;
-        p.type = FireworkType::Sphere;
-        p.isTail = false;
-        p.canExplodeAgain = canExplode;
-        explosionParticles.push_back(p);
-    }
-}
-
-// 环形烟花
-void FireworkParticleSystem::generateRingParticles(const glm::vec3& center, const glm::vec4& color, int count, float radiusScale) {
-    for (int i = 0; i < count; ++i) {
-        float angle = (float)i / count * 2.0f * 3.14159265f;
-        float r = radiusScale * (0.9f + 0.2f * dis(gen));
-
-        Particle p;
-        p.position = center;
-        p.velocity = glm::vec3(
-            cos(angle) * r,
-            0.5f + dis(gen) * 0.5f, // 轻微向上
-            sin(angle) * r
-        ) * 2.0f;
-        p.color = color;
-        p.initialColor = color;
-        p.life = 0.35f + 0.15f * dis(gen);  // 🔧 缩短：0.35-0.5秒（原本 0.6-0.85秒）
-        p.maxLife = p.life;
-        p.size = childSize;
-        p.type = FireworkType::Ring;
-        p.isTail = false;
-        p.canExplodeAgain = false;
-        explosionParticles.push_back(p);
-    }
-}
-
-// 多层烟花
-void FireworkParticleSystem::generateMultiLayerParticles(const glm::vec3& center, const glm::vec4& color, int count, float radiusScale) {
-    int layers = 3;
-    int particlesPerLayer = count / layers;
-    float baseRadius = radiusScale * 0.8f;
-
-    for (int layer = 0; layer < layers; ++layer) {
-        float layerRadius = baseRadius + layer * (radiusScale * 0.3f);
-        glm::vec4 layerColor = color;
-        
-        // 每层不同颜色变化
-        if (layer == 1) {
-            layerColor = glm::vec4(color.r * 0.8f, color.g * 1.2f, color.b * 0.9f, color.a);
-        }
-        else if (layer == 2) {
-            layerColor = glm::vec4(color.r * 1.2f, color.g * 0.9f, color.b * 1.1f, color.a);
-        }
-
-        for (int i = 0; i < particlesPerLayer; ++i) {
-            float u = dis(gen);
-            float v = dis(gen);
-            float theta = u * 2.0f * 3.14159265f;
-            float phi = acos(2.0f * v - 1.0f);
-
-            Particle p;
-            p.position = center;
-            p.velocity = glm::vec3(
-                sin(phi) * cos(theta),
-                sin(phi) * sin(theta),
-                cos(phi)
-            ) * layerRadius * 2.2f;
-            p.color = layerColor;
-            p.initialColor = layerColor;
-			// 外层寿命更长 （整体寿命：）
-            p.life = 0.4f + 0.15f * dis(gen) + layer * 0.1f; // 🔧 缩短：0.3-0.6秒（原本 0.5-1.1秒）
-            p.maxLife = p.life;
-            p.size = childSize * (1.0f + layer * 0.02f); // 外层更大
-            p.type = FireworkType::MultiLayer;
-            p.isTail = false;
-            p.canExplodeAgain = false;
-            explosionParticles.push_back(p);
-        }
-    }
-}
-
-// 螺旋烟花
-void FireworkParticleSystem::generateSpiralParticles(const glm::vec3& center, const glm::vec4& color, int count, float radiusScale) {
-    int spirals = 3; // 3条螺旋线
-    for (int i = 0; i < count; ++i) {
-        int spiralIdx = i % spirals;
-        float baseAngle = (float)spiralIdx / spirals * 2.0f * 3.14159265f;
-        float angleOffset = (float)i / count * 4.0f * 3.14159265f; // 多圈螺旋
-        float angle = baseAngle + angleOffset;
-        
-        float r = radiusScale * (0.4f + (float)i / count * 0.8f); // 半径逐渐增大
-
-        Particle p;
-        p.position = center;
-        p.velocity = glm::vec3(
-            cos(angle) * r * 0.8f,
-            1.5f + dis(gen) * 0.5f,
-            sin(angle) * r * 0.8f
-        ) * 2.0f;
-        p.color = color;
-        p.initialColor = color;
-        p.life = 0.45f + 0.15f * dis(gen);  // 🔧 缩短：0.45-0.6秒（原本 0.75-1.0秒）
-        p.maxLife = p.life;
-        p.size = childSize;
-        p.type = FireworkType::Spiral;
-        p.isTail = false;
-        p.canExplodeAgain = false;
-        p.rotationAngle = angle; // 初始旋转角度
-        explosionParticles.push_back(p);
-    }
-}
-
-// 心形烟花 - 🔧 缩短生命周期
-void FireworkParticleSystem::generateHeartParticles(const glm::vec3& center, const glm::vec4& color, int count, float radiusScale) {
-    for (int i = 0; i < count; ++i) {
-        float t = (float)i / count * 2.0f * 3.14159265f;
-        
-        // 心形参数方程
-        float x = 16.0f * pow(sin(t), 3);
-        float y = 13.0f * cos(t) - 5.0f * cos(2.0f * t) - 2.0f * cos(3.0f * t) - cos(4.0f * t);
-        
-        // 缩放和添加随机性
-        float scale = 0.15f * (radiusScale / 3.0f);
-        x *= scale;
-        y *= scale;
-
-        Particle p;
-        p.position = center;
-        p.velocity = glm::vec3(
-            x + dis(gen) * 0.3f,
-            y + dis(gen) * 0.3f + 1.0f, // 向上偏移
-            dis(gen) * 0.5f - 0.25f // Z方向随机
-        ) * 3.2f;
-        p.color = color;
-        p.initialColor = color;
-        p.life = 0.45f + 0.15f * dis(gen);  // 🔧 缩短：0.45-0.6秒（原本 0.75-1.0秒）
-        p.maxLife = p.life;
-        p.size = childSize;
-        p.type = FireworkType::Heart;
-        p.isTail = false;
-        p.canExplodeAgain = false;
-        explosionParticles.push_back(p);
-    }
-}
-
-// 测试方法：依次发射各种类型烟花
-void FireworkParticleSystem::runTest(float currentTime) {
-    static float lastTestTime = 0.0f;
-    static bool skipNextLaunch = false; // 跟踪是否需要跳过下一次发射
-
-    // 每0.8秒发射一次
-    if (currentTime - lastTestTime < 0.8f) return;
-
-    lastTestTime = currentTime;
-
-    // 如果上次是图片烟花，跳过这次发射
-    if (skipNextLaunch) {
-        skipNextLaunch = false;
-        return;
-    }
-
-    // 生成完全随机的HSV颜色对
-    auto generateRandomColorPair = []() -> std::pair<glm::vec4, glm::vec4> {
-        // 随机生成主色（使用HSV模型，全范围随机）
-        float hue1 = dis(gen);           // 色相：0.0-1.0 全范围
-        float saturation1 = dis(gen);    // 饱和度：0.0-1.0 全范围
-        float value1 = 0.5f + dis(gen) * 0.5f; // 亮度：0.5-1.0（确保颜色不太暗）
-
-        glm::vec4 primaryColor = HSVtoRGB(hue1, saturation1, value1);
-
-        // 生成相近的辅色（在HSV空间微调）
-        // 色相偏移：-0.2到0.2之间
-        float hueOffset = (dis(gen) * 0.4f) - 0.2f;
-        float hue2 = fmod(hue1 + hueOffset + 1.0f, 1.0f);
-
-        // 饱和度和亮度也随机微调（确保在0.0-1.0范围内）
-        float saturation2 = glm::clamp(saturation1 + (dis(gen) * 0.3f - 0.15f), 0.0f, 1.0f);
-        float value2 = glm::clamp(value1 + (dis(gen) * 0.3f - 0.15f), 0.0f, 1.0f);
-
-        glm::vec4 secondaryColor = HSVtoRGB(hue2, saturation2, value2);
-
-        return { primaryColor, secondaryColor };
-    };
-
-    // 随机位置（x在0到14之间，z在-9到-3之间）
-    float randomX = -4.0f + dis(gen) * 14.0f;
-    float randomZ = -2.5f + dis(gen) * 4.0f;
-    glm::vec3 launchPos(randomX, 0.5f, randomZ);
-
-    // 随机尺寸（0.1f到0.15f）
-    float randomSize = 0.21f + dis(gen) * 0.01f;
-
-    // 随机选择烟花类型（Image概率为15%）
-    float typeRoll = dis(gen);
-    FireworkType selectedType;
-    
-    if (typeRoll < 0.15f) {
-        // 15% 概率：Image（随机选择word.png或image.png）
-        selectedType = FireworkType::Image;
-        std::string imagePath = (dis(gen) < 0.5f) 
-            ? "assets/firework_images/word.png" 
-            : "assets/firework_images/image.png";
-        
-        Particle launcher;
-        launcher.position = launchPos;
-        launcher.velocity = glm::vec3(0.0f, 12.0f, 0.0f);
-        launcher.color = glm::vec4(1.0f);
-        launcher.initialColor = glm::vec4(1.0f);
-        launcher.secondaryColor = glm::vec4(1.0f);
-        launcher.life = 1.5f * (0.4f + dis(gen) * 0.2f);
-        launcher.maxLife = launcher.life;
-        launcher.size = randomSize * 3.5f;
-        launcher.type = selectedType;
-        launcher.isTail = false;
-        launcher.canExplodeAgain = false;
-        launcher.isDualColor = false;
-        launcher.rotationAngle = 0.0f;
-        launcher.imagePath = imagePath;  // 设置图片路径
-        
-        // 播放升空音效
-        if (audioInitialized) {
-            int index = static_cast<int>(dis(gen) * 2) % 2;
-            std::string path = "assets/sounds/firework/rise/firework_rise_0" + std::to_string(index + 1) + ".wav";
-            ma_engine_play_sound(&audioEngine, path.c_str(), NULL);
-        }
-        
-        launcherParticles.push_back(launcher);
-        skipNextLaunch = true; // 图片烟花发射后，跳过下一次发射
-        return;
-    }
-    else if (typeRoll < 0.15f + 0.3f) {
-        // 35% 概率：双层不同色Sphere
-        selectedType = FireworkType::Sphere;
-        auto colors = generateRandomColorPair();
-        launch(launchPos, selectedType, 1.5f, colors.first, colors.second, randomSize);
-    }
-    else if (typeRoll < 0.15f + 0.7f) {
-        // 35% 概率：三层不同色Sphere（使用MultiLayer）
-        selectedType = FireworkType::MultiLayer;
-        auto colors = generateRandomColorPair();
-        launch(launchPos, selectedType, 1.5f, colors.first, colors.second, randomSize);
-    }
-    else {
-        // 15% 概率：单层Heart
-        selectedType = FireworkType::Heart;
-        auto colors = generateRandomColorPair();
-        // 单层Heart使用相同颜色（不是双色）
-        launch(launchPos, selectedType, 1.5f, colors.first, glm::vec4(1.0f), randomSize);
-    }
+    setViewPoint(glm::vec3(glm::inverse(view)[3])); // 相机位置（粒子预算的相关性）
+    setViewFrustum(proj * view);                     // 视锥体剔除
+    setScreenScale(0.5f * proj[1][1] * viewportHeight); // 拖尾按屏幕位移采样（第一次渲染前视口未知，按固定间隔）
 }
 
 void FireworkParticleSystem::cleanupGL() {
+    gpuParticles.reset(); // GPU 粒子缓冲有自己的 GL 资源
+    analyticParticles.reset();
+
     if (!glInited) return; // 如果GL未初始化，直接返回
 
-    // 删除顶点缓冲对象
-    if (vbo) {
-        glDeleteBuffers(1, &vbo);
-        vbo = 0;
-    }
+    // 删除顶点流缓冲
+    stream.cleanupGL();
+    trailStream.cleanupGL();
 
     // 删除顶点数组对象
     if (vao) {
         glDeleteVertexArrays(1, &vao);
         vao = 0;
     }
+    if (billboardVao) {
+        glDeleteVertexArrays(1, &billboardVao);
+        billboardVao = 0;
+    }
+    if (trailVao) {
+        glDeleteVertexArrays(1, &trailVao);
+        trailVao = 0;
+    }
+    if (quadVbo) {
+        glDeleteBuffers(1, &quadVbo);
+        quadVbo = 0;
+    }
+    if (rampTexture) {
+        glDeleteTextures(1, &rampTexture);
+        rampTexture = 0;
+    }
+    rampRevision = 0xFFFFFFFFu;
 
     // 删除 Shader 对象（假设你用 new Shader 创建）
     if (shader) {
         delete shader;
         shader = nullptr;
     }
-
-    glInited = false;
-}
-
-// 加载图片数据
-FireworkParticleSystem::ImageData FireworkParticleSystem::loadImage(const std::string& imagePath) {
-    ImageData data;
-    data.width = 0;
-    data.height = 0;
-
-    int channels;
-    unsigned char* imageData = stbi_load(imagePath.c_str(), &data.width, &data.height, &channels, 4); // 强制加载为RGBA
-    
-    if (!imageData) {
-        std::cerr << "Failed to load image: " << imagePath << std::endl;
-        return data;
+    if (billboardShader) {
+        delete billboardShader;
+        billboardShader = nullptr;
     }
-
-    std::cout << "Loaded image: " << imagePath << " (" << data.width << "x" << data.height << ")" << std::endl;
-
-    // 将图片数据转换为glm::vec4数组
-    data.pixels.resize(data.width * data.height);
-    for (int y = 0; y < data.height; ++y) {
-        for (int x = 0; x < data.width; ++x) {
-            int index = (y * data.width + x) * 4;
-            int pixelIndex = y * data.width + x;
-            
-            data.pixels[pixelIndex] = glm::vec4(
-                imageData[index] / 255.0f,     // R
-                imageData[index + 1] / 255.0f, // G
-                imageData[index + 2] / 255.0f, // B
-                imageData[index + 3] / 255.0f  // A
-            );
-        }
+    if (trailShader) {
+        delete trailShader;
+        trailShader = nullptr;
     }
 
-    stbi_image_free(imageData);
-    return data;
+    glInited = false;
 }
-
-// 生成图片烟花粒子
-void FireworkParticleSystem::generateImageParticles(const glm::vec3& center, const std::string& imagePath, int sampleRate) {
-    // 加载图片
-    ImageData image = loadImage(imagePath);
-    if (image.width == 0 || image.height == 0) {
-        std::cerr << "Image load failed, cannot create image firework!" << std::endl;
-        return;
-    }
-
-    // 不采样，处理每个像素
-    int step = 1;
-    
-    // 计算图片缩放比例，使其在3D空间中合适大小
-    float scaleX = 4.0f / image.width;  // 图片宽度映射到4个单位
-    float scaleY = 4.0f / image.height; // 图片高度映射到4个单位
-    float scale = (std::min)(scaleX, scaleY); // 使用较小的缩放保持比例
-
-    // 图片中心化
-    float offsetX = (image.width * scale) / 2.0f;
-    float offsetY = (image.height * scale) / 2.0f;
-
-    int particleCount = 0;
-
-    // 遍历图片像素，创建粒子
-    for (int y = 0; y < image.height; y += step) {
-        for (int x = 0; x < image.width; x += step) {
-            int index = y * image.width + x;
-            glm::vec4 pixelColor = image.pixels[index];
-
-            // 跳过透明像素
-            if (pixelColor.a < 0.1f) continue;
-
-            // 计算粒子在图片中的相对位置（以图片中心为原点）
-            float posX = x * scale - offsetX;
-            float posY = offsetY - y * scale; // 反转Y坐标，修正上下颠倒
-			//posX *= 0.2f; // 进一步缩小X轴比例，防止图片过宽
-			//posY *= 0.2f; // 进一步缩小Y轴比例，防止图片过高
-            Particle p;
-            p.position = center; // 初始位置在爆炸中心
-            
-            // 速度：从中心向外扩散，保持图片形状
-            // 初始速度：向图片对应位置扩散（放大效果）
-            // 扩散速度基于距离中心的位置
-            float expandSpeed = 0.8f; // 扩散速度系数
-            p.velocity = glm::vec3(posX * expandSpeed, posY * expandSpeed, 0.0f) * 2.5f;
-            
-            // 降低亮度避免bloom效果（bloom阈值为1.5）
-            p.color = pixelColor * 0.2f;
-            p.initialColor = pixelColor * 0.2f;
-            
-            p.life = 0.8f;
-            p.maxLife = p.life;
-            p.size = 0.02f;
-            p.type = FireworkType::Image;
-            p.isTail = true;  
-            p.canExplodeAgain = false;
-            
-            explosionParticles.push_back(p);
-            particleCount++;
-        }
-    }
-
-    std::cout << "Created image firework with " << particleCount << " particles" << std::endl;
-}
\ No newline at end of file
@@ -0,0 +1,860 @@
+#include "FireworkSimulation.h"
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+// HSV 转 RGB（h/s/v 取值 0~1）
+glm::vec4 HSVtoRGB(float h, float s, float v) {
+    float r, g, b;
+
+    int i = static_cast<int>(h * 6);
+    float f = h * 6 - i;
+    float p = v * (1 - s);
+    float q = v * (1 - f * s);
+    float t = v * (1 - (1 - f) * s);
+
+    switch (i % 6) {
+    case 0: r = v; g = t; b = p; break;
+    case 1: r = q; g = v; b = p; break;
+    case 2: r = p; g = v; b = t; break;
+    case 3: r = p; g = q; b = v; break;
+    case 4: r = t; g = p; b = v; break;
+    case 5: r = v; g = p; b = q; break;
+    }
+
+    return glm::vec4(r, g, b, 1.0f);
+}
+
+// 默认使用随机的演出种子；需要复现某次演出时用 setSeed 指定
+FireworkSimulation::FireworkSimulation() {
+    std::random_device rd;
+    setSeed((static_cast<uint64_t>(rd()) << 32) | rd());
+
+    // 默认预算 26 万粒子（1024 块，每块约 35 KB，共约 36 MB），一次分配，之后内存占用不再增长
+    setParticleBudget(1 << 18);
+
+    // 启动时建好内置烟花描述用到的形状模板
+    warmShapes();
+}
+
+// 为目录中每条发射指令预先建表，避免第一次爆炸时建表
+void FireworkSimulation::warmShapes() {
+    for (const SpawnOp& op : shells.allOps()) shapes.warm(op.shape, op.count);
+}
+
+int FireworkSimulation::loadShells(const std::string& path) {
+    int loaded = shells.loadFile(path);
+    warmShapes();
+    std::cout << "[Firework] Loaded " << loaded << " shells from " << path << std::endl;
+    return loaded;
+}
+
+void FireworkSimulation::setSeed(uint64_t seed) {
+    showSeed = seed;
+    burstSerial = 0;
+    showRandom.reseed(FastRandom::deriveSeed(seed, 0));
+}
+
+// 每个爆发一条独立的随机流：只取决于演出种子和爆发序号
+FastRandom FireworkSimulation::burstRandom() {
+    return FastRandom(FastRandom::deriveSeed(showSeed, ++burstSerial));
+}
+
+// 一次取出 count 个 [0, 1) 随机数（缓冲在下一次调用前有效）
+const float* FireworkSimulation::randomBatch(FastRandom& rng, size_t count) {
+    if (randomScratch.size() < count) randomScratch.resize(count);
+    rng.fill(randomScratch.data(), count);
+    return randomScratch.data();
+}
+
+void FireworkSimulation::addEventSink(FireworkEventSink* sink) {
+    if (sink) eventSinks.push_back(sink);
+}
+
+void FireworkSimulation::setHandOff(ParticleHandOff* target) {
+    handOff = target;
+}
+
+void FireworkSimulation::setParticleBudget(size_t maxParticles) {
+    size_t chunks = (std::max)((maxParticles + ParticleChunk::CAPACITY - 1) / ParticleChunk::CAPACITY, size_t(1));
+    chunkArena.setCapacity(chunks);
+    std::cout << "[Firework] Particle budget: " << chunks * ParticleChunk::CAPACITY << " particles (" << chunks << " chunks)" << std::endl;
+}
+
+void FireworkSimulation::setViewPoint(const glm::vec3& eye) {
+    viewPoint = eye;
+    hasViewPoint = true;
+}
+
+void FireworkSimulation::setViewFrustum(const glm::mat4& viewProj) {
+    viewFrustum.setViewProj(viewProj);
+    clipW = glm::vec4(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+}
+
+void FireworkSimulation::setScreenScale(float pixelsPerUnit) {
+    screenScale = pixelsPerUnit;
+}
+
+// 爆发的包围球随块年龄解析增长：初速度带来的位移不超过 maxSpeed × age（阻力只会让它更小），
+// 重力带来的下落在 0 到 gravity × age² / 2 之间，球心取其中点、半径加上一半（多个发射点时再加上它们的分布范围）
+void FireworkSimulation::burstBounds(const ParticleChunk& chunk, glm::vec3& center, float& radius) const {
+    const Burst& b = bursts[chunk.burst];
+    float age = chunk.age;
+    float fall = 0.25f * gravity * age * age;
+    center = b.origin + glm::vec3(0.0f, fall, 0.0f);
+    radius = b.spread + b.maxSpeed * age + std::abs(fall) + childSize; // 加上粒子本身的大小
+}
+
+bool FireworkSimulation::chunkVisible(const ParticleChunk& chunk) const {
+    if (!frustumCulling || !viewFrustum.valid || chunk.burst == ParticleChunk::NO_BURST) return true;
+    glm::vec3 center;
+    float radius;
+    burstBounds(chunk, center, radius);
+    return viewFrustum.intersectsSphere(center, radius);
+}
+
+// 在包围球离相机最近处移动 tailMinPixels 像素所需的世界距离（平方）；屏幕缩放未知时返回 -1。
+// 用最近处的深度估算，同一组粒子里离相机最近的那些决定是否采样，远处的爆发自然很少采样
+float FireworkSimulation::trailMinMoveSq(const glm::vec3& center, float radius) const {
+    if (screenScale <= 0.0f) return -1.0f;
+    float depth = glm::dot(glm::vec3(clipW), center) + clipW.w - radius * glm::length(glm::vec3(clipW));
+    float distance = tailMinPixels * (std::max)(depth, 0.05f) / screenScale;
+    return distance * distance;
+}
+
+size_t FireworkSimulation::particleCount() const {
+    return launcherParticles.count() + explosionChunks.liveParticleCount();
+}
+
+int FireworkSimulation::trailSpacing() const {
+    float dt = stepDelta();
+    int spacing = dt > 0.0f ? static_cast<int>(tailInterval / dt + 0.5f) : 1;
+    return (std::max)(spacing, 1);
+}
+
+int FireworkSimulation::trailMinGap() const {
+    float dt = stepDelta();
+    if (dt <= 0.0f) return 1;
+    int gap = static_cast<int>(std::ceil(tailLife / dt / (TrailRing::SAMPLES - 1)));
+    return (std::max)(gap, 1);
+}
+
+void FireworkSimulation::launch(const glm::vec3& position, FireworkType type, float life,
+    const glm::vec4& primaryColor, const glm::vec4& secondaryColor, float size) {
+    launchProgram(position, shells.forType(type), life, primaryColor, secondaryColor, size);
+}
+
+bool FireworkSimulation::launchShell(const glm::vec3& position, const std::string& name, float life,
+    const glm::vec4& primaryColor, const glm::vec4& secondaryColor, float size, const std::string& imagePath) {
+    uint32_t shell = shells.find(name);
+    if (shell == ShellCatalog::NOT_FOUND) {
+        std::cerr << "[Firework] Unknown shell: " << name << std::endl;
+        return false;
+    }
+    launchProgram(position, shell, life, primaryColor, secondaryColor, size, imagePath);
+    return true;
+}
+
+void FireworkSimulation::launchBatch(const LaunchRequest* requests, size_t count) {
+    // 按倍增预留：连续的齐射不会每批都重新分配
+    size_t needed = launcherParticles.count() + count;
+    if (launcherParticles.capacity() < needed) launcherParticles.reserve((std::max)(needed, launcherParticles.capacity() * 2));
+    size_t burstsNeeded = bursts.size() - freeBursts.size() + count;
+    if (bursts.capacity() < burstsNeeded) bursts.reserve((std::max)(burstsNeeded, bursts.capacity() * 2));
+
+    static const std::string noImage;
+    for (size_t i = 0; i < count; ++i) {
+        const LaunchRequest& r = requests[i];
+        if (r.shell >= shells.size()) {
+            std::cerr << "[Firework] Unknown shell id " << r.shell << " in launch batch (request " << i << ")" << std::endl;
+            continue;
+        }
+        launchProgram(r.position, r.shell, r.life, r.primaryColor, r.secondaryColor, r.size, r.imagePath ? *r.imagePath : noImage);
+    }
+}
+
+void FireworkSimulation::launchProgram(const glm::vec3& position, uint32_t shell, float life,
+    const glm::vec4& primaryColor, const glm::vec4& secondaryColor, float size, const std::string& imagePath) {
+    // 随机位置（x在-8到8之间，z在-5到5之间）
+    glm::vec3 randomPos = position;
+    if (position == glm::vec3(0.0f, 0.5f, 0.0f)) {
+        randomPos.x = (showRandom.uniform() * 16.0f) - 8.0f;  // -8到8
+        randomPos.z = (showRandom.uniform() * 10.0f) - 5.0f;  // -5到5
+    }
+
+    // 随机寿命，让爆炸高度随机；🔧 增大升空粒子大小（原本是 size，现在是 2.5 倍）
+    spawnLauncher(randomPos, shell, life * (0.6f + showRandom.uniform() * 0.2f), primaryColor, secondaryColor, size * 2.5f, imagePath);
+}
+
+// 分配一个爆发槽位（优先复用已回收的槽位）
+uint32_t FireworkSimulation::allocBurst(FireworkType type, const glm::vec4& primaryColor, const glm::vec4& secondaryColor) {
+    uint32_t index;
+    if (!freeBursts.empty()) {
+        index = freeBursts.back();
+        freeBursts.pop_back();
+        bursts[index] = Burst();
+    }
+    else {
+        index = static_cast<uint32_t>(bursts.size());
+        bursts.emplace_back();
+    }
+
+    Burst& b = bursts[index];
+    b.type = type;
+    b.primaryColor = primaryColor;
+    b.secondaryColor = secondaryColor;
+    b.isDualColor = (secondaryColor != glm::vec4(1.0f));  // 如果是默认值，则是单色
+    return index;
+}
+
+// 粒子死亡时调用：爆发的最后一个粒子死亡后回收其槽位
+void FireworkSimulation::releaseBurst(uint32_t index) {
+    if (index == ParticleStore::NO_BURST) return;
+    Burst& b = bursts[index];
+    if (b.refCount > 0 && --b.refCount == 0) {
+        b.imagePath.clear();
+        if (b.emitters != NO_EMITTERS) {
+            emitterLists[b.emitters].clear();
+            freeEmitterLists.push_back(b.emitters);
+            b.emitters = NO_EMITTERS;
+        }
+        freeBursts.push_back(index);
+    }
+}
+
+// 向爆发追加一个粒子；每申请一个新块，爆发的引用计数加一
+void FireworkSimulation::spawnParticle(ChunkWriter& writer, const glm::vec3& position,
+    const glm::vec3& velocity, const glm::vec4& color, float life, float size, float angle) {
+    if (writer.push(position, velocity, color, life, size, angle)) {
+        bursts[writer.burstIndex()].refCount++;
+    }
+}
+
+void FireworkSimulation::spawnLauncher(const glm::vec3& position, uint32_t shell, float life,
+    const glm::vec4& primaryColor, const glm::vec4& secondaryColor, float size, const std::string& imagePath) {
+    FireworkType type = shells.shell(shell).type;
+    uint32_t burst = allocBurst(type, primaryColor, secondaryColor);
+    bursts[burst].shell = shell;
+    bursts[burst].imagePath = imagePath;
+
+    glm::vec3 fixedVelocity(0.0f, 12.0f, 0.0f);
+    launcherParticles.push(position, fixedVelocity, primaryColor, life, size, burst);
+    bursts[burst].refCount++;
+
+    // 通知音效等表现层
+    for (FireworkEventSink* sink : eventSinks) sink->onLaunch(position, type);
+}
+
+void FireworkSimulation::update(float deltaTime) {
+    // 单帧最多追赶 maxSubSteps 步：长时间卡顿后丢弃多出的时间，而不是让后续帧越积越多
+    int maxSteps = (std::max)(maxSubSteps, 1);
+    accumulator += (std::min)(deltaTime, fixedStep * maxSteps);
+
+    float dt = stepDelta();
+    float dragFactor = stepDrag();
+    subStepsTaken = 0;
+    while (accumulator >= fixedStep) {
+        stepIndex = subStepsTaken;
+        step(dt, dragFactor);
+        accumulator -= fixedStep;
+        subStepsTaken++;
+    }
+    stepIndex = 0;
+}
+
+// drag 按 1/60 秒定义，换算到当前步长，改变 fixedStep 不影响减速快慢
+float FireworkSimulation::stepDrag() const {
+    return std::pow(drag, fixedStep * 60.0f);
+}
+
+// 推进一个固定步长（dt 为乘以 timeScale 后的模拟时间）
+void FireworkSimulation::step(float dt, float dragFactor) {
+    float gravityStep = gravity * dt;
+    int spacing = trailSpacing();
+    int minGap = trailMinGap();
+
+    // 1. 更新上升粒子（所有上升粒子共用一个拖尾位置环：任一带拖尾的上升粒子需要采样时，全部记下积分前的位置）
+    ParticleStore& L = launcherParticles;
+    L.trail.tick();
+    bool gapReached = L.trail.filled == 0 || L.trail.age(0) >= minGap;
+    bool trailDue = L.trail.filled == 0 || (gapReached && screenScale <= 0.0f && L.trail.age(0) >= spacing);
+    for (size_t i = 0, n = L.count(); i < n && gapReached && !trailDue && screenScale > 0.0f; ++i) {
+        if (L.life[i] <= 0.0f || !bursts[L.burst[i]].emitsTail) continue;
+        glm::vec3 position = L.position(i);
+        glm::vec3 move = position - L.trailPosition(i, L.trail.slot(0));
+        trailDue = L.trailFilled[i] == 0 || glm::dot(move, move) >= trailMinMoveSq(position, 0.0f);
+    }
+    int trailSlot = trailDue ? L.trail.record() : -1;
+    explodeScratch.clear();
+    for (size_t i = 0, n = L.count(); i < n; ++i) {
+        if (L.life[i] > 0.0f) {
+            glm::vec3 prevPos = L.position(i);
+            L.prevX[i] = prevPos.x;
+            L.prevY[i] = prevPos.y;
+            L.prevZ[i] = prevPos.z;
+            L.posX[i] += L.velX[i] * dt;
+            L.posY[i] += L.velY[i] * dt;
+            L.posZ[i] += L.velZ[i] * dt;
+            L.velY[i] += gravityStep;
+            L.life[i] -= dt;
+            
+            if (trailSlot >= 0 && bursts[L.burst[i]].emitsTail) L.recordTrail(i, trailSlot, prevPos);
+        }
+
+        if (L.velY[i] <= 0.0f || L.life[i] <= 0.0f) {
+            explodeScratch.push_back(i);
+        }
+    }
+
+    for (size_t i : explodeScratch) {
+        createExplosion(L.position(i), L.burst[i]);
+        L.life[i] = 0.0f; // 已爆炸的上升粒子在本帧末移除，避免重复爆炸
+    }
+
+    // 2. 更新爆炸粒子
+    if (handOff) {
+        // 设置了接管者（如 GPU 模拟）：新生成的爆炸粒子整批交出，CPU 不再模拟（子发射器的块除外）
+        handOffChunks();
+    }
+    updateExplosionChunks(dt, dragFactor, spacing, minGap);
+    emitSubShells();
+
+    // 3. 执行本步内到期的延迟爆炸事件（烟花描述中的后续阶段）
+    delayedExplosions.runDue(simTime + dt, [this](const DelayedExplosion& delayed) {
+        runStage(delayed.position, delayed.burst, delayed.stage);
+        releaseBurst(delayed.burst);
+    });
+
+    // 移除死亡的上升粒子，同时释放其所属爆发
+    launcherParticles.removeIf(
+        [this](size_t i) { return launcherParticles.life[i] <= 0.0f || launcherParticles.posY[i] < 0.0f; },
+        [this](size_t i) { releaseBurst(launcherParticles.burst[i]); });
+
+    // 爆炸粒子：整块到期后一次回收，不再逐粒子压缩
+    explosionChunks.retireExpired([this](ParticleChunk& c) { releaseBurst(c.burst); });
+    simTime += dt;
+}
+
+// 爆炸粒子：按块范围拆分成任务，在线程池上并行执行（每个任务只写自己的块，结果与执行线程无关）
+void FireworkSimulation::updateExplosionChunks(float dt, float dragFactor, int trailSpacing, int trailMinGap) {
+    std::vector<ParticleChunk*>& chunks = explosionChunks.active;
+    size_t perJob = multithreadedUpdate ? jobSystem().itemsPerJob(chunks.size(), 4) : chunks.size();
+    size_t jobCount = chunks.empty() ? 0 : (chunks.size() + perJob - 1) / perJob;
+    for (ParticleChunk* chunk : chunks) chunk->offscreen = !chunkVisible(*chunk);
+    if (subEmitQueues.size() < jobCount) subEmitQueues.resize(jobCount);
+
+    runJobs(jobCount, [&](size_t job, unsigned) {
+        for (size_t k = job * perJob, end = (std::min)(k + perJob, chunks.size()); k < end; ++k) {
+            updateExplosionChunk(*chunks[k], dt, dragFactor, trailSpacing, trailMinGap, subEmitQueues[job]);
+        }
+    });
+}
+
+// 把所有爆炸粒子块交给接管者，块在本帧末整块回收；
+// 子发射器的块留在 CPU 上（接管者只做解析积分，无法在粒子熄灭处生成子烟花）
+void FireworkSimulation::handOffChunks() {
+    for (ParticleChunk* chunk : explosionChunks.active) {
+        if (chunk->aliveCount <= 0 || bursts[chunk->burst].subShell != ShellCatalog::NOT_FOUND) continue;
+        handOff->takeParticles(*chunk, bursts[chunk->burst].spin);
+        chunk->aliveCount = 0;
+    }
+}
+
+// 单个爆炸粒子块的积分（在工作线程上执行，只写本块和本任务的子发射队列）
+void FireworkSimulation::updateExplosionChunk(ParticleChunk& c, float dt, float dragFactor, int trailSpacing, int trailMinGap,
+    std::vector<SubEmit>& subEmits) const {
+    if (c.aliveCount <= 0) return; // 已交给接管者或已被预算回收
+    const Burst& burst = bursts[c.burst];
+
+    // 离屏降频：视锥体外的块每 offscreenTickInterval 步才积分一次，一次补上累积的步数；
+    // 回到视野内的块在下一步立即补齐
+    int steps = c.pendingSteps + 1;
+    if (c.offscreen && steps < offscreenTickInterval) {
+        c.pendingSteps = steps;
+        return;
+    }
+    c.pendingSteps = 0;
+    if (steps > 1) {
+        dt *= steps;
+        dragFactor = std::pow(dragFactor, static_cast<float>(steps));
+    }
+    c.age += dt;
+
+    // 拖尾：距最新采样至少 trailMinGap 步、且块内粒子在屏幕上移动超过 tailMinPixels（屏幕缩放未知时按固定间隔）时，
+    // 把整块粒子积分前的位置复制到位置环最老的槽位；慢的、远的爆发很少采样，快的按最小间隔采样。
+    // 视锥体外不记录，并清空旧的采样（回到视野时不会连出一段跨越离屏时间的拖尾）
+    if (burst.emitsTail && !c.offscreen) {
+        c.trail.tick();
+        bool due = c.trail.filled == 0;
+        if (!due && c.trail.age(0) >= trailMinGap) {
+            glm::vec3 center;
+            float radius;
+            burstBounds(c, center, radius);
+            float minMoveSq = trailMinMoveSq(center, radius);
+            due = minMoveSq < 0.0f ? c.trail.age(0) >= trailSpacing
+                                   : ParticleKernels::maxTrailMoveSq(simdLevel, c, c.trail.newest) >= minMoveSq;
+        }
+        if (due) {
+            int slot = c.trail.record();
+            std::copy_n(c.posX, c.count, c.trailX[slot]);
+            std::copy_n(c.posY, c.count, c.trailY[slot]);
+            std::copy_n(c.posZ, c.count, c.trailZ[slot]);
+        }
+    }
+    else {
+        c.trail.reset();
+    }
+
+    // 螺旋烟花旋转（含三角函数，保留标量循环）
+    if (burst.spin != 0.0f) {
+        for (int i = 0; i < c.count; ++i) {
+            if (c.life[i] <= 0.0f) continue;
+            c.rotation[i] += dt * burst.spin;
+            float radius = glm::length(glm::vec2(c.velX[i], c.velZ[i]));
+            c.velX[i] = radius * cos(c.rotation[i]);
+            c.velZ[i] = radius * sin(c.rotation[i]);
+        }
+    }
+
+    // 子发射：块年龄到达 subTime 时整块粒子熄灭；subTime 为 0 时在寿命结束时熄灭，
+    // 按 subEmitWindow 对齐：每个窗口开始时把窗口内将耗尽寿命的粒子一起熄灭（否则每步只有零星几个，各占一块）。
+    // 这里只记录发射点，子烟花在全部块更新完后按爆发合并成批生成
+    if (burst.subShell != ShellCatalog::NOT_FOUND) {
+        auto emit = [&](int i) {
+            subEmits.push_back({ { glm::vec3(c.posX[i], c.posY[i], c.posZ[i]), glm::vec3(c.velX[i], c.velY[i], c.velZ[i]) }, c.burst });
+        };
+        if (burst.subTime > 0.0f) {
+            if (c.age >= burst.subTime && c.age - dt < burst.subTime) {
+                for (int i = 0; i < c.count; ++i) {
+                    if (c.life[i] <= 0.0f) continue;
+                    emit(i);
+                    c.kill(i);
+                }
+                return;
+            }
+        }
+        else {
+            // 窗口开始时向后多看一步（步长不一定整除窗口），其余各步只接住本步就会耗尽寿命的粒子
+            bool windowStart = subEmitWindow > 0.0f &&
+                (c.age <= dt || std::floor(c.age / subEmitWindow) != std::floor((c.age - dt) / subEmitWindow));
+            float lookAhead = windowStart ? subEmitWindow + dt : dt;
+            for (int i = 0; i < c.count; ++i) {
+                if (c.life[i] <= 0.0f || c.life[i] - lookAhead > 0.0f) continue;
+                emit(i);
+                c.kill(i);
+            }
+        }
+    }
+
+    // 积分、空气阻力、寿命和死亡标记由向量化内核完成（同时保存积分前的位置用于渲染插值）
+    ParticleKernels::integrate(simdLevel, c, dt, gravity * dt, dragFactor);
+}
+
+// 子发射：把本步各任务记录的熄灭粒子按所属爆发合并成批，每批分配一个子烟花爆发（持有这批发射点），
+// 再像上升弹爆炸一样执行子烟花的阶段。同一爆发在一步内熄灭的所有粒子共用一个子爆发、从同一组块开始写入，
+// 不再逐粒子分配；子烟花的延迟阶段通过爆发引用保留发射点列表
+void FireworkSimulation::emitSubShells() {
+    if (subEmitQueues.empty()) return;
+
+    // 按任务顺序合并到第一个队列：同一爆发的块可能被拆到相邻的任务里，合并后分批与线程数无关
+    std::vector<SubEmit>& queue = subEmitQueues[0];
+    for (size_t j = 1; j < subEmitQueues.size(); ++j) {
+        queue.insert(queue.end(), subEmitQueues[j].begin(), subEmitQueues[j].end());
+        subEmitQueues[j].clear();
+    }
+
+    // 先为所有批分配爆发（此时还不生成粒子、不会回收块，父爆发的数据保持有效）
+    subScratch.clear();
+    for (size_t begin = 0; begin < queue.size();) {
+        uint32_t parent = queue[begin].burst;
+        size_t end = begin + 1;
+        while (end < queue.size() && queue[end].burst == parent) ++end;
+
+        // 复制父爆发数据：分配新爆发时 bursts 可能扩容
+        uint32_t shell = bursts[parent].subShell;
+        glm::vec4 primaryColor = bursts[parent].primaryColor;
+        glm::vec4 secondaryColor = bursts[parent].secondaryColor;
+        uint32_t program = allocBurst(shells.shell(shell).type, primaryColor, secondaryColor);
+        uint32_t list = allocEmitterList();
+        bursts[program].shell = shell;
+        bursts[program].imagePath = bursts[parent].imagePath;
+        bursts[program].emitters = list;
+        bursts[program].refCount = 1; // 立即执行的阶段完成后释放
+
+        std::vector<Emitter>& emitters = emitterLists[list];
+        glm::vec3 center(0.0f);
+        for (size_t k = begin; k < end; ++k) {
+            emitters.push_back(queue[k].emitter);
+            center += queue[k].emitter.position;
+        }
+        subScratch.emplace_back(center / static_cast<float>(end - begin), program);
+        begin = end;
+    }
+    queue.clear();
+
+    for (const auto& sub : subScratch) {
+        createExplosion(sub.first, sub.second);
+        releaseBurst(sub.second);
+    }
+}
+
+uint32_t FireworkSimulation::allocEmitterList() {
+    if (!freeEmitterLists.empty()) {
+        uint32_t index = freeEmitterLists.back();
+        freeEmitterLists.pop_back();
+        return index;
+    }
+    emitterLists.emplace_back();
+    return static_cast<uint32_t>(emitterLists.size() - 1);
+}
+
+JobSystem& FireworkSimulation::jobSystem() {
+    // 延迟到第一次更新时创建线程池，避免在全局对象构造期间启动线程
+    if (!jobs) {
+        jobs = std::make_unique<JobSystem>(workerThreads);
+        std::cout << "[Firework] Particle update uses " << jobs->workerCount() << " threads, "
+                  << ParticleKernels::levelName(simdLevel) << " kernels" << std::endl;
+    }
+    return *jobs;
+}
+
+void FireworkSimulation::runJobs(size_t jobCount, const JobSystem::JobFn& fn) {
+    if (multithreadedUpdate) {
+        jobSystem().run(jobCount, fn);
+        return;
+    }
+    for (size_t j = 0; j < jobCount; ++j) fn(j, 0);
+}
+
+// 创建爆炸粒子：立即执行烟花描述中 delay 为 0 的阶段，其余阶段排入延迟爆炸队列
+void FireworkSimulation::createExplosion(const glm::vec3& position, uint32_t sourceBurst) {
+    const ShellProgram& program = shells.shell(bursts[sourceBurst].shell);
+    for (uint32_t s = 0; s < program.stageCount; ++s) {
+        float delay = shells.stage(program.firstStage + s).delay;
+        if (delay <= 0.0f) {
+            runStage(position, sourceBurst, s);
+            continue;
+        }
+        DelayedExplosion delayed;
+        delayed.position = position;
+        delayed.burst = sourceBurst;
+        delayed.stage = s;
+        delayedExplosions.push(simTime + delay, delayed);
+        bursts[sourceBurst].refCount++; // 上升粒子移除后来源爆发仍需保留到该阶段执行
+    }
+}
+
+// 阶段的颜色来源：双色烟花的辅色阶段使用 secondaryColor，单色烟花回退到主色
+glm::vec4 FireworkSimulation::stageColor(ShellColor color, const Burst& source) {
+    switch (color) {
+    case ShellColor::Secondary:
+        return source.isDualColor ? source.secondaryColor : source.primaryColor;
+    case ShellColor::White:
+        return glm::vec4(1.0f);
+    default:
+        return source.primaryColor;
+    }
+}
+
+// 执行一个阶段的全部发射指令（第 0 阶段之后的阶段和子烟花按二次爆炸通知表现层）
+void FireworkSimulation::runStage(const glm::vec3& position, uint32_t sourceBurst, uint32_t stage) {
+    // 复制一份来源爆发数据：生成新粒子时 bursts 可能扩容
+    const Burst source = bursts[sourceBurst];
+    const ShellStage& s = shells.stage(shells.shell(source.shell).firstStage + stage);
+
+    // 发射点：子烟花使用记录的发射点列表（来源爆发持有，执行期间不会回收），上升弹爆炸是静止的单点
+    Emitter single = { position, glm::vec3(0.0f) };
+    const Emitter* emitters = &single;
+    size_t emitterCount = 1;
+    if (source.emitters != NO_EMITTERS) {
+        emitters = emitterLists[source.emitters].data();
+        emitterCount = emitterLists[source.emitters].size();
+    }
+    bool secondary = stage > 0 || source.emitters != NO_EMITTERS;
+
+    // 通知音效、光源等表现层
+    glm::vec4 eventColor = s.opCount > 0 ? stageColor(shells.op(s.firstOp).color, source) : source.primaryColor;
+    for (FireworkEventSink* sink : eventSinks) sink->onExplosion(position, source.type, eventColor, secondary);
+
+    SpawnPriority priority = secondary ? SpawnPriority::Secondary : SpawnPriority::Primary;
+    for (uint32_t k = 0; k < s.opCount; ++k) {
+        executeSpawnOp(shells.op(s.firstOp + k), emitters, emitterCount, source, priority);
+    }
+}
+
+// 屏幕相关性（0~1）：relevanceDistance 以内为 1，更远处按距离反比衰减；未设置观察点时都为 1
+float FireworkSimulation::relevance(const glm::vec3& position) const {
+    if (!hasViewPoint) return 1.0f;
+    float distance = glm::length(position - viewPoint);
+    return distance <= relevanceDistance ? 1.0f : relevanceDistance / distance;
+}
+
+// 粒子预算准入：返回允许生成的粒子数（每条发射指令从新块开始写，需要 ceil(count / CAPACITY) 块）
+// 预算紧张时远处的爆炸先按相关性缩减；块不够时回收低优先级的块，仍不够则缩减到剩余预算
+int FireworkSimulation::admitParticles(int count, SpawnPriority priority, const glm::vec3& center) {
+    if (chunkArena.used() > chunkArena.capacity() * budgetSoftLimit) {
+        float scale = (std::max)(relevance(center), minRelevanceScale);
+        count = (std::max)(static_cast<int>(count * scale + 0.5f), 1);
+    }
+
+    size_t needed = (static_cast<size_t>(count) + ParticleChunk::CAPACITY - 1) / ParticleChunk::CAPACITY;
+    if (chunkArena.available() < needed) makeRoom(needed, priority);
+
+    size_t available = chunkArena.available();
+    if (available < needed) count = static_cast<int>(available * ParticleChunk::CAPACITY);
+    return count;
+}
+
+// 为优先级为 priority 的爆炸腾出块，直到可用块数达到 needed：
+// 先回收已到期的块，再回收优先级不高于它的爆炸块
+// （二次爆炸先于主爆炸，同级按 剩余寿命比例 × 相关性 从低到高，视锥体外的块相关性为 0，最先回收）
+// 只在两次生成之间调用（此时没有正在写入的 ChunkWriter）
+void FireworkSimulation::makeRoom(size_t needed, SpawnPriority priority) {
+    auto retire = [this]() {
+        explosionChunks.retireExpired([this](ParticleChunk& c) { releaseBurst(c.burst); });
+    };
+    retire();
+    if (chunkArena.available() >= needed) return;
+
+    cullScratch.clear();
+    for (ParticleChunk* chunk : explosionChunks.active) {
+        const Burst& b = bursts[chunk->burst];
+        if (b.priority < priority) continue; // 不回收更高优先级的块
+        int probe = chunk->count / 2;
+        float remaining = chunk->maxLifetime > 0.0f ? 1.0f - glm::clamp(chunk->age / chunk->maxLifetime, 0.0f, 1.0f) : 0.0f;
+        float score = chunkVisible(*chunk) ? remaining * relevance(glm::vec3(chunk->posX[probe], chunk->posY[probe], chunk->posZ[probe])) : 0.0f;
+        if (b.priority == SpawnPriority::Secondary) score -= 1.0f; // 二次爆炸排在所有主爆炸之前
+        cullScratch.emplace_back(score, chunk);
+    }
+
+    size_t missing = (std::min)(needed - chunkArena.available(), cullScratch.size());
+    std::partial_sort(cullScratch.begin(), cullScratch.begin() + missing, cullScratch.end(),
+        [](const std::pair<float, ParticleChunk*>& a, const std::pair<float, ParticleChunk*>& b) { return a.first < b.first; });
+    for (size_t k = 0; k < missing; ++k) cullScratch[k].second->aliveCount = 0;
+    retire();
+}
+
+// 执行一条发射指令：所有形状共用同一个生成循环，形状差异全部来自模板和指令中的数值。
+// 多个发射点（子烟花）整批准入、写入同一个爆发，每个发射点按形状生成一组粒子并叠加发射点的速度
+void FireworkSimulation::executeSpawnOp(const SpawnOp& op, const Emitter* emitters, size_t emitterCount, const Burst& source, SpawnPriority priority) {
+    if (op.shape == ShapeKind::Image) {
+        for (size_t e = 0; e < emitterCount; ++e) executeImageOp(op, emitters[e].position, source, priority);
+        return;
+    }
+    if (op.count <= 0 || emitterCount == 0) return;
+
+    // 发射点的中心和分布范围（包围球的起点和基础半径）
+    glm::vec3 center = emitters[0].position;
+    float spread = 0.0f;
+    if (emitterCount > 1) {
+        center = glm::vec3(0.0f);
+        for (size_t e = 0; e < emitterCount; ++e) center += emitters[e].position;
+        center /= static_cast<float>(emitterCount);
+        for (size_t e = 0; e < emitterCount; ++e) spread = (std::max)(spread, glm::length(emitters[e].position - center));
+    }
+
+    // 质量调节：每个发射点的粒子数按比例缩减，但至少保留一个；再经粒子预算准入（整批一起准入）
+    int perEmitter = (std::max)(static_cast<int>(op.count * particleScale + 0.5f), 1);
+    int admitted = admitParticles(perEmitter * static_cast<int>(emitterCount), priority, center);
+    if (admitted <= 0) return;
+
+    glm::vec4 base = stageColor(op.color, source);
+    glm::vec4 color(glm::vec3(base) * op.tint, base.a);
+    uint32_t burst = allocBurst(source.type, color, source.secondaryColor);
+    bursts[burst].emitsTail = op.tail;
+    bursts[burst].spin = op.spin;
+    bursts[burst].ramp = op.ramp;
+    bursts[burst].priority = priority;
+    bursts[burst].origin = center;
+    bursts[burst].spread = spread;
+    bursts[burst].subShell = op.sub;
+    bursts[burst].subTime = op.subTime;
+    if (op.sub != ShellCatalog::NOT_FOUND) bursts[burst].imagePath = source.imagePath;
+    ChunkWriter writer(explosionChunks, burst);
+
+    ShapeView shape = shapes.view(op.shape, op.count);
+    FastRandom rng = burstRandom();
+    bool sampled = shape.mask != 0xFFFFFFFFu;
+    float size = childSize * op.sizeScale;
+    float maxSpeed2 = 0.0f;
+    // 准入的粒子数均分到各发射点（余数给前面的发射点）
+    const int share = admitted / static_cast<int>(emitterCount);
+    const size_t extra = static_cast<size_t>(admitted) % emitterCount;
+    for (size_t e = 0; e < emitterCount; ++e) {
+        int count = share + (e < extra ? 1 : 0);
+        if (count <= 0) break;
+        const Emitter& emitter = emitters[e];
+
+        // 模板下标用 32.32 定点数步进：球面方向表取随机起点 + 奇数步长，得到一组不重复的方向；
+        // 按粒子数建的表从头均匀取点（粒子数缩减时隔点取，形状保持完整）
+        uint64_t index = sampled ? static_cast<uint64_t>(rng.next()) << 32 : 0u;
+        uint64_t stride = sampled ? static_cast<uint64_t>(rng.next() | 1u) << 32 : (static_cast<uint64_t>(op.count) << 32) / count;
+        const float* rnd = randomBatch(rng, count * 5); // 每个粒子 5 个随机数：半径、x/y/z 抖动、寿命
+        for (int i = 0; i < count; ++i, rnd += 5, index += stride) {
+            uint32_t k = static_cast<uint32_t>(index >> 32) & shape.mask;
+            float r = op.radius * (op.radialBase + op.radialJitter * rnd[0]);
+            glm::vec3 velocity = (shape.velocity[k] * r + op.lift + op.jitter * glm::vec3(rnd[1], rnd[2], rnd[3])) * op.speed + emitter.velocity;
+            float life = op.lifeBase + op.lifeJitter * rnd[4];
+            spawnParticle(writer, emitter.position, velocity, color, life, size, shape.angle[k]); // 初始角度供旋转使用
+            maxSpeed2 = (std::max)(maxSpeed2, glm::dot(velocity, velocity));
+        }
+    }
+    bursts[burst].maxSpeed = std::sqrt(maxSpeed2);
+}
+
+// 测试方法：依次发射各种类型烟花
+void FireworkSimulation::runTest(float currentTime) {
+    // 每0.8秒发射一次
+    if (currentTime - testLastTime < 0.8f) return;
+
+    testLastTime = currentTime;
+
+    // 如果上次是图片烟花，跳过这次发射
+    if (testSkipNext) {
+        testSkipNext = false;
+        return;
+    }
+
+    // 生成完全随机的HSV颜色对
+    auto generateRandomColorPair = [this]() -> std::pair<glm::vec4, glm::vec4> {
+        // 随机生成主色（使用HSV模型，全范围随机）
+        float hue1 = showRandom.uniform();           // 色相：0.0-1.0 全范围
+        float saturation1 = showRandom.uniform();    // 饱和度：0.0-1.0 全范围
+        float value1 = 0.5f + showRandom.uniform() * 0.5f; // 亮度：0.5-1.0（确保颜色不太暗）
+
+        glm::vec4 primaryColor = HSVtoRGB(hue1, saturation1, value1);
+
+        // 生成相近的辅色（在HSV空间微调）
+        // 色相偏移：-0.2到0.2之间
+        float hueOffset = (showRandom.uniform() * 0.4f) - 0.2f;
+        float hue2 = fmod(hue1 + hueOffset + 1.0f, 1.0f);
+
+        // 饱和度和亮度也随机微调（确保在0.0-1.0范围内）
+        float saturation2 = glm::clamp(saturation1 + (showRandom.uniform() * 0.3f - 0.15f), 0.0f, 1.0f);
+        float value2 = glm::clamp(value1 + (showRandom.uniform() * 0.3f - 0.15f), 0.0f, 1.0f);
+
+        glm::vec4 secondaryColor = HSVtoRGB(hue2, saturation2, value2);
+
+        return { primaryColor, secondaryColor };
+    };
+
+    // 随机位置（x在0到14之间，z在-9到-3之间）
+    float randomX = -4.0f + showRandom.uniform() * 14.0f;
+    float randomZ = -2.5f + showRandom.uniform() * 4.0f;
+    glm::vec3 launchPos(randomX, 0.5f, randomZ);
+
+    // 随机尺寸（0.1f到0.15f）
+    float randomSize = 0.21f + showRandom.uniform() * 0.01f;
+
+    // 随机选择烟花类型（Image概率为15%）
+    float typeRoll = showRandom.uniform();
+    FireworkType selectedType;
+    
+    if (typeRoll < 0.15f) {
+        // 15% 概率：Image（随机选择word.png或image.png）
+        selectedType = FireworkType::Image;
+        std::string imagePath = (showRandom.uniform() < 0.5f) 
+            ? "assets/firework_images/word.png" 
+            : "assets/firework_images/image.png";
+        
+        spawnLauncher(launchPos, shells.forType(selectedType), 1.5f * (0.4f + showRandom.uniform() * 0.2f),
+            glm::vec4(1.0f), glm::vec4(1.0f), randomSize * 3.5f, imagePath);  // 设置图片路径
+        testSkipNext = true; // 图片烟花发射后，跳过下一次发射
+        return;
+    }
+    else if (typeRoll < 0.15f + 0.3f) {
+        // 35% 概率：双层不同色Sphere
+        selectedType = FireworkType::Sphere;
+        auto colors = generateRandomColorPair();
+        launch(launchPos, selectedType, 1.5f, colors.first, colors.second, randomSize);
+    }
+    else if (typeRoll < 0.15f + 0.7f) {
+        // 35% 概率：三层不同色Sphere（使用MultiLayer）
+        selectedType = FireworkType::MultiLayer;
+        auto colors = generateRandomColorPair();
+        launch(launchPos, selectedType, 1.5f, colors.first, colors.second, randomSize);
+    }
+    else {
+        // 15% 概率：单层Heart
+        selectedType = FireworkType::Heart;
+        auto colors = generateRandomColorPair();
+        // 单层Heart使用相同颜色（不是双色）
+        launch(launchPos, selectedType, 1.5f, colors.first, glm::vec4(1.0f), randomSize);
+    }
+}
+
+void FireworkSimulation::preloadImages(const std::vector<std::string>& imagePaths) {
+    imageCache.preload(imagePaths);
+}
+
+// 图片烟花的发射指令：粒子数和颜色来自缓存的图片模板，批量实例化
+// 速度 = 像素偏移 × radius × speed，颜色 = 像素颜色 / 255 × tint；同一图片的粒子寿命相同（不使用 lifeJitter）
+void FireworkSimulation::executeImageOp(const SpawnOp& op, const glm::vec3& center, const Burst& source, SpawnPriority priority) {
+    // 图片烟花使用动态路径（从爆发中获取），未指定时回退到默认路径
+    const std::string& imagePath = source.imagePath.empty() ? std::string("assets/firework_images/image.png") : source.imagePath;
+    ImageTemplateCache::TemplatePtr image = imageCache.get(imagePath);
+    if (!image || image->points.empty()) {
+        std::cerr << "Image load failed, cannot create image firework!" << std::endl;
+        return;
+    }
+
+    // 质量调节：粒子数缩减时隔点取像素；粒子预算不足时加大间隔
+    const int pointCount = static_cast<int>(image->points.size());
+    int step = particleScale < 1.0f ? (std::max)(static_cast<int>(1.0f / particleScale + 0.5f), 1) : 1;
+    int admitted = admitParticles((pointCount + step - 1) / step, priority, center);
+    if (admitted <= 0) return;
+    step = (std::max)(step, (pointCount + admitted - 1) / admitted);
+
+    uint32_t burst = allocBurst(source.type, glm::vec4(1.0f), source.secondaryColor);
+    bursts[burst].emitsTail = op.tail;
+    bursts[burst].spin = op.spin;
+    bursts[burst].ramp = op.ramp;
+    bursts[burst].priority = priority;
+    bursts[burst].origin = center;
+    bursts[burst].subShell = op.sub;
+    bursts[burst].subTime = op.subTime;
+    if (op.sub != ShellCatalog::NOT_FOUND) bursts[burst].imagePath = source.imagePath;
+    ChunkWriter writer(explosionChunks, burst);
+
+    const float velocityScale = op.radius * op.speed;
+    const glm::vec4 colorScale = glm::vec4(op.tint, 1.0f) / 255.0f;
+    const float life = op.lifeBase;
+    const float size = childSize * op.sizeScale;
+
+    // 下一个取样点在模板中的下标（只在循环内按下标取点，最后一段之后不会形成越界指针）
+    size_t next = 0;
+    const int total = (pointCount + step - 1) / step;
+    int remaining = total;
+    float maxOffset2 = 0.0f;
+    while (remaining > 0) {
+        int first = 0, got = 0;
+        bool newChunk = false;
+        ParticleChunk* c = writer.claim(remaining, life, first, got, newChunk);
+        if (!c) break;
+        if (newChunk) bursts[burst].refCount++;
+
+        // 相同的属性整段填充，初始位置在爆炸中心
+        std::fill_n(c->posX + first, got, center.x);
+        std::fill_n(c->posY + first, got, center.y);
+        std::fill_n(c->posZ + first, got, center.z);
+        std::fill_n(c->velZ + first, got, 0.0f);
+        std::fill_n(c->life + first, got, life);
+        std::fill_n(c->maxLife + first, got, life);
+        std::fill_n(c->sizes + first, got, size);
+        std::fill_n(c->rotation + first, got, 0.0f);
+        for (int k = 0; k < got; ++k) {
+            const ImagePoint& pt = image->points[next + static_cast<size_t>(k) * step];
+            c->velX[first + k] = pt.offsetX * velocityScale;
+            c->velY[first + k] = pt.offsetY * velocityScale;
+            c->baseColor[first + k] = glm::vec4(pt.r, pt.g, pt.b, pt.a) * colorScale;
+            maxOffset2 = (std::max)(maxOffset2, pt.offsetX * pt.offsetX + pt.offsetY * pt.offsetY);
+        }
+
+        next += static_cast<size_t>(got) * step;
+        remaining -= got;
+    }
+
+    bursts[burst].maxSpeed = std::sqrt(maxOffset2) * std::abs(velocityScale);
+    std::cout << "Created image firework with " << total << " particles" << std::endl;
+}
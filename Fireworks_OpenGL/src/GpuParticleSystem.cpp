@@ -0,0 +1,197 @@
+﻿#include "GpuParticleSystem.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+GpuParticleSystem::GpuParticleSystem(size_t capacity)
+    : maxParticles((std::max)(capacity, size_t(1))) {
+}
+
+GpuParticleSystem::~GpuParticleSystem() {
+    cleanupGL();
+}
+
+void GpuParticleSystem::spawn(const Particle& particle, int delaySteps) {
+    if (delaySteps > 0) {
+        delayed.push_back({ particle, delaySteps });
+        return;
+    }
+    pending.push_back(particle);
+}
+
+void GpuParticleSystem::initGL() {
+    if (glInited) return;
+
+    updateProgram = buildUpdateProgram("assets/shaders/particle_update.vs");
+    renderShader = new Shader("assets/shaders/particle_gpu.vs", "assets/shaders/firework.fs");
+
+    // 两块缓冲大小相同，一次分配到位，之后只做局部写入
+    glGenBuffers(2, buffers);
+    glGenVertexArrays(2, vaos);
+    for (int i = 0; i < 2; ++i) {
+        glBindVertexArray(vaos[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, maxParticles * sizeof(Particle), nullptr, GL_DYNAMIC_COPY);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, posLife));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, velMaxLife));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, color));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, params));
+        glEnableVertexAttribArray(3);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::cout << "[GpuParticles] Transform feedback buffers: " << maxParticles << " particles x2 ("
+              << (maxParticles * sizeof(Particle) * 2) / (1024 * 1024) << " MB)" << std::endl;
+    glInited = true;
+}
+
+// 更新程序只有顶点着色器，输出变量需在链接前登记为变换反馈变量
+GLuint GpuParticleSystem::buildUpdateProgram(const char* vertexPath) {
+    std::string code;
+    std::ifstream file(vertexPath);
+    if (!file) {
+        std::cerr << "[GpuParticles] Failed to open " << vertexPath << std::endl;
+    }
+    else {
+        std::stringstream stream;
+        stream << file.rdbuf();
+        code = stream.str();
+    }
+    const char* source = code.c_str();
+
+    GLint success;
+    GLchar infoLog[1024];
+    GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &source, NULL);
+    glCompileShader(vertex);
+    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(vertex, 1024, NULL, infoLog);
+        std::cerr << "[GpuParticles] Update shader compile error:\n" << infoLog << std::endl;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    const char* varyings[] = { "outPosLife", "outVelMaxLife", "outColor", "outParams" };
+    glTransformFeedbackVaryings(program, 4, varyings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 1024, NULL, infoLog);
+        std::cerr << "[GpuParticles] Update program link error:\n" << infoLog << std::endl;
+    }
+    glDeleteShader(vertex);
+    return program;
+}
+
+// 把本帧新粒子写入当前缓冲的环形位置（超出容量时只保留最新的部分）
+void GpuParticleSystem::uploadPending() {
+    if (pending.empty()) return;
+
+    const Particle* src = pending.data();
+    size_t n = pending.size();
+    if (n > maxParticles) {
+        src += n - maxParticles;
+        n = maxParticles;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[current]);
+    size_t first = (std::min)(n, maxParticles - head);
+    glBufferSubData(GL_ARRAY_BUFFER, head * sizeof(Particle), first * sizeof(Particle), src);
+    if (n > first) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (n - first) * sizeof(Particle), src + first);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    for (size_t i = 0; i < n; ++i) remainingLife = (std::max)(remainingLife, src[i].posLife.w);
+    head = (head + n) % maxParticles;
+    usedSlots = (std::min)(usedSlots + n, maxParticles);
+    pending.clear();
+}
+
+// 推迟的粒子跳过了一次 simulate：等待次数到期的移入 pending，在下一次 simulate 开始时上传
+void GpuParticleSystem::promoteDelayed() {
+    if (delayed.empty()) return;
+
+    size_t kept = 0;
+    for (DelayedParticle& d : delayed) {
+        if (--d.steps <= 0) pending.push_back(d.particle);
+        else delayed[kept++] = d;
+    }
+    delayed.resize(kept);
+}
+
+void GpuParticleSystem::simulate(float dt, float gravity, float drag) {
+    if (!glInited) initGL();
+
+    // 缓冲内的粒子已全部死亡：从头开始使用，避免继续模拟空槽位
+    remainingLife -= dt;
+    if (remainingLife <= 0.0f && pending.empty()) {
+        usedSlots = 0;
+        head = 0;
+        remainingLife = 0.0f;
+        promoteDelayed();
+        return;
+    }
+    uploadPending();
+
+    glUseProgram(updateProgram);
+    glUniform1f(glGetUniformLocation(updateProgram, "dt"), dt);
+    glUniform1f(glGetUniformLocation(updateProgram, "gravity"), gravity);
+    glUniform1f(glGetUniformLocation(updateProgram, "drag"), drag);
+
+    // 只做顶点处理，不光栅化：读 buffers[current]，写 buffers[1 - current]
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(vaos[current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers[1 - current]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)usedSlots);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    current = 1 - current;
+    promoteDelayed();
+}
+
+void GpuParticleSystem::render(const glm::mat4& view, const glm::mat4& projection, float pointScale) {
+    if (!glInited || usedSlots == 0) return;
+
+    renderShader->use();
+    renderShader->setMat4("view", view);
+    renderShader->setMat4("projection", projection);
+    renderShader->setFloat("pointScale", pointScale);
+    renderShader->setInt("colorRamp", 0);
+    glBindVertexArray(vaos[current]);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)usedSlots);
+    glBindVertexArray(0);
+}
+
+void GpuParticleSystem::cleanupGL() {
+    if (!glInited) return;
+
+    glDeleteBuffers(2, buffers);
+    glDeleteVertexArrays(2, vaos);
+    buffers[0] = buffers[1] = 0;
+    vaos[0] = vaos[1] = 0;
+    if (updateProgram) {
+        glDeleteProgram(updateProgram);
+        updateProgram = 0;
+    }
+    if (renderShader) {
+        delete renderShader;
+        renderShader = nullptr;
+    }
+    usedSlots = 0;
+    head = 0;
+    remainingLife = 0.0f;
+    pending.clear();
+    delayed.clear();
+    glInited = false;
+}
@@ -0,0 +1,57 @@
+﻿#include "GpuTimer.h"
+#include <algorithm>
+
+GpuTimer::GpuTimer(size_t framesInFlight)
+    : queries((std::max)(framesInFlight, size_t(2)), 0) {
+}
+
+GpuTimer::~GpuTimer() {
+    cleanupGL();
+}
+
+void GpuTimer::begin() {
+    if (queries[0] == 0) glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    if (active || inFlight == queries.size()) return;
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[writeIndex]);
+    active = true;
+}
+
+void GpuTimer::end() {
+    if (!active) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    writeIndex = (writeIndex + 1) % queries.size();
+    inFlight++;
+    active = false;
+}
+
+bool GpuTimer::poll(float& ms) {
+    bool got = false;
+    while (inFlight > 0) {
+        GLuint query = queries[readIndex];
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        ms = static_cast<float>(elapsed) * 1e-6f;
+        readIndex = (readIndex + 1) % queries.size();
+        inFlight--;
+        got = true;
+    }
+    return got;
+}
+
+void GpuTimer::cleanupGL() {
+    if (queries[0] == 0) return;
+
+    if (active) glEndQuery(GL_TIME_ELAPSED);
+    glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    std::fill(queries.begin(), queries.end(), 0);
+    writeIndex = 0;
+    readIndex = 0;
+    inFlight = 0;
+    active = false;
+}
@@ -0,0 +1,99 @@
+﻿#include "ImageTemplateCache.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+ImageTemplateCache::~ImageTemplateCache() {
+    clear();
+}
+
+void ImageTemplateCache::preload(const std::vector<std::string>& paths) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& path : paths) {
+        if (entries.count(path)) continue;
+        entries[path] = std::async(std::launch::async, &ImageTemplateCache::decode, path).share();
+    }
+}
+
+ImageTemplateCache::TemplatePtr ImageTemplateCache::get(const std::string& path) {
+    std::shared_future<TemplatePtr> entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(path);
+        if (it == entries.end()) {
+            // 未预加载：在当前线程同步解码，并放入缓存
+            std::promise<TemplatePtr> loaded;
+            loaded.set_value(decode(path));
+            it = entries.emplace(path, loaded.get_future().share()).first;
+        }
+        entry = it->second;
+    }
+    // 在锁外等待，避免阻塞其他路径的查询
+    return entry.get();
+}
+
+bool ImageTemplateCache::isReady(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(path);
+    return it != entries.end() &&
+        it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void ImageTemplateCache::clear() {
+    std::map<std::string, std::shared_future<TemplatePtr>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.swap(entries);
+    }
+    // 等待仍在运行的后台解码结束，保证析构后没有线程访问缓存
+    for (auto& entry : pending) entry.second.wait();
+}
+
+// 解码图片并转换为模板（可在任意线程调用）
+ImageTemplateCache::TemplatePtr ImageTemplateCache::decode(const std::string& path) {
+    int width = 0, height = 0, channels = 0;
+    stbi_set_flip_vertically_on_load_thread(false);
+    unsigned char* imageData = stbi_load(path.c_str(), &width, &height, &channels, 4); // 强制加载为RGBA
+
+    if (!imageData) {
+        std::cerr << "Failed to load image: " << path << std::endl;
+        return nullptr;
+    }
+
+    auto tmpl = std::make_shared<ImageTemplate>();
+    tmpl->width = width;
+    tmpl->height = height;
+
+    // 计算图片缩放比例，使其在3D空间中合适大小
+    float scaleX = 4.0f / width;  // 图片宽度映射到4个单位
+    float scaleY = 4.0f / height; // 图片高度映射到4个单位
+    float scale = (std::min)(scaleX, scaleY); // 使用较小的缩放保持比例
+
+    // 图片中心化
+    float offsetX = (width * scale) / 2.0f;
+    float offsetY = (height * scale) / 2.0f;
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const unsigned char* px = imageData + (y * width + x) * 4;
+
+            // 跳过透明像素
+            if (px[3] / 255.0f < 0.1f) continue;
+
+            ImagePoint point;
+            point.offsetX = x * scale - offsetX;
+            point.offsetY = offsetY - y * scale; // 反转Y坐标，修正上下颠倒
+            point.r = px[0];
+            point.g = px[1];
+            point.b = px[2];
+            point.a = px[3];
+            tmpl->points.push_back(point);
+        }
+    }
+
+    stbi_image_free(imageData);
+    std::cout << "Loaded image template: " << path << " (" << width << "x" << height
+        << ", " << tmpl->points.size() << " points)" << std::endl;
+    return tmpl;
+}
@@ -2,14 +2,14 @@
 #include "Camera.h"
 #include "PointLight.h"
 #include "FireworkParticleSystem.h"
+#include "FastRandom.h"
 #include "PostProcessor.h"
 #include <iostream>
 #include <UIManager.h>
 #include <random>
 
-static std::random_device rd;
-static std::mt19937 gen(rd());
-static std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+// 手动发射烟花的随机颜色/寿命（用户操作本身不可复现，因此单独一条随机流）
+static FastRandom inputRandom(std::random_device{}());
 
 
 // 外部变量声明（在 main.cpp 中定义）
@@ -25,27 +25,6 @@ extern PostProcessor* postProcessor;
 extern int g_fireworkKeyPressCount;
 extern UIManager* uiManager;
 
-glm::vec4 HSVtoRGB(float h, float s, float v) {
-    float r, g, b;
-
-    int i = static_cast<int>(h * 6);
-    float f = h * 6 - i;
-    float p = v * (1 - s);
-    float q = v * (1 - f * s);
-    float t = v * (1 - (1 - f) * s);
-
-    switch (i % 6) {
-    case 0: r = v; g = t; b = p; break;
-    case 1: r = q; g = v; b = p; break;
-    case 2: r = p; g = v; b = t; break;
-    case 3: r = p; g = q; b = v; break;
-    case 4: r = t; g = p; b = v; break;
-    case 5: r = v; g = p; b = q; break;
-    }
-
-    return glm::vec4(r, g, b, 1.0f);
-}
-
 // 处理所有输入
 void processInput(GLFWwindow* window)
 {
@@ -340,13 +319,13 @@ void processInput(GLFWwindow* window)
         glm::vec3 launchPos = glm::vec3(0.0f, 0.5f, 0.0f);
 
         // 生成完全随机的主色
-        float hue = dis(gen); // 全范围随机
-        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + dis(gen) * 0.3f, 0.8f + dis(gen) * 0.2f);
+        float hue = inputRandom.uniform(); // 全范围随机
+        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + inputRandom.uniform() * 0.3f, 0.8f + inputRandom.uniform() * 0.2f);
 
         // 生成相近但不同的辅色
-        float hueOffset = (dis(gen) * 0.25f) - 0.125f; // 更大的偏移范围
-        float satOffset = (dis(gen) * 0.2f) - 0.1f;
-        float valOffset = (dis(gen) * 0.2f) - 0.1f;
+        float hueOffset = (inputRandom.uniform() * 0.25f) - 0.125f; // 更大的偏移范围
+        float satOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
+        float valOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
 
         glm::vec4 secondaryColor = HSVtoRGB(fmod(hue + hueOffset + 1.0f, 1.0f),
             glm::clamp(primaryColor.g + satOffset, 0.6f, 1.0f),
@@ -369,13 +348,13 @@ void processInput(GLFWwindow* window)
         glm::vec3 launchPos = glm::vec3(0.0f, 0.5f, 0.0f);
 
         // 生成完全随机的主色
-        float hue = dis(gen); // 全范围随机
-        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + dis(gen) * 0.3f, 0.8f + dis(gen) * 0.2f);
+        float hue = inputRandom.uniform(); // 全范围随机
+        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + inputRandom.uniform() * 0.3f, 0.8f + inputRandom.uniform() * 0.2f);
 
         // 生成相近但不同的辅色
-        float hueOffset = (dis(gen) * 0.25f) - 0.125f; // 更大的偏移范围
-        float satOffset = (dis(gen) * 0.2f) - 0.1f;
-        float valOffset = (dis(gen) * 0.2f) - 0.1f;
+        float hueOffset = (inputRandom.uniform() * 0.25f) - 0.125f; // 更大的偏移范围
+        float satOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
+        float valOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
 
         glm::vec4 secondaryColor = HSVtoRGB(fmod(hue + hueOffset + 1.0f, 1.0f),
             glm::clamp(primaryColor.g + satOffset, 0.6f, 1.0f),
@@ -398,13 +377,13 @@ void processInput(GLFWwindow* window)
         glm::vec3 launchPos = glm::vec3(0.0f, 0.5f, 0.0f);
 
         // 生成完全随机的主色
-        float hue = dis(gen); // 全范围随机
-        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + dis(gen) * 0.3f, 0.8f + dis(gen) * 0.2f);
+        float hue = inputRandom.uniform(); // 全范围随机
+        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + inputRandom.uniform() * 0.3f, 0.8f + inputRandom.uniform() * 0.2f);
 
         // 生成相近但不同的辅色
-        float hueOffset = (dis(gen) * 0.25f) - 0.125f; // 更大的偏移范围
-        float satOffset = (dis(gen) * 0.2f) - 0.1f;
-        float valOffset = (dis(gen) * 0.2f) - 0.1f;
+        float hueOffset = (inputRandom.uniform() * 0.25f) - 0.125f; // 更大的偏移范围
+        float satOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
+        float valOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
 
         glm::vec4 secondaryColor = HSVtoRGB(fmod(hue + hueOffset + 1.0f, 1.0f),
             glm::clamp(primaryColor.g + satOffset, 0.6f, 1.0f),
@@ -427,13 +406,13 @@ void processInput(GLFWwindow* window)
         glm::vec3 launchPos = glm::vec3(0.0f, 0.5f, 0.0f);
 
         // 生成完全随机的主色
-        float hue = dis(gen); // 全范围随机
-        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + dis(gen) * 0.3f, 0.8f + dis(gen) * 0.2f);
+        float hue = inputRandom.uniform(); // 全范围随机
+        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + inputRandom.uniform() * 0.3f, 0.8f + inputRandom.uniform() * 0.2f);
 
         // 生成相近但不同的辅色
-        float hueOffset = (dis(gen) * 0.25f) - 0.125f; // 更大的偏移范围
-        float satOffset = (dis(gen) * 0.2f) - 0.1f;
-        float valOffset = (dis(gen) * 0.2f) - 0.1f;
+        float hueOffset = (inputRandom.uniform() * 0.25f) - 0.125f; // 更大的偏移范围
+        float satOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
+        float valOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
 
         glm::vec4 secondaryColor = HSVtoRGB(fmod(hue + hueOffset + 1.0f, 1.0f),
             glm::clamp(primaryColor.g + satOffset, 0.6f, 1.0f),
@@ -456,13 +435,13 @@ void processInput(GLFWwindow* window)
         glm::vec3 launchPos = glm::vec3(0.0f, 0.5f, 0.0f);
 
         // 生成完全随机的主色
-        float hue = dis(gen); // 全范围随机
-        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + dis(gen) * 0.3f, 0.8f + dis(gen) * 0.2f);
+        float hue = inputRandom.uniform(); // 全范围随机
+        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + inputRandom.uniform() * 0.3f, 0.8f + inputRandom.uniform() * 0.2f);
 
         // 生成相近但不同的辅色
-        float hueOffset = (dis(gen) * 0.25f) - 0.125f; // 更大的偏移范围
-        float satOffset = (dis(gen) * 0.2f) - 0.1f;
-        float valOffset = (dis(gen) * 0.2f) - 0.1f;
+        float hueOffset = (inputRandom.uniform() * 0.25f) - 0.125f; // 更大的偏移范围
+        float satOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
+        float valOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
 
         glm::vec4 secondaryColor = HSVtoRGB(fmod(hue + hueOffset + 1.0f, 1.0f),
             glm::clamp(primaryColor.g + satOffset, 0.6f, 1.0f),
@@ -485,13 +464,13 @@ void processInput(GLFWwindow* window)
         glm::vec3 launchPos = glm::vec3(0.0f, 0.5f, 0.0f);
 
         // 生成完全随机的主色
-        float hue = dis(gen); // 全范围随机
-        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + dis(gen) * 0.3f, 0.8f + dis(gen) * 0.2f);
+        float hue = inputRandom.uniform(); // 全范围随机
+        glm::vec4 primaryColor = HSVtoRGB(hue, 0.7f + inputRandom.uniform() * 0.3f, 0.8f + inputRandom.uniform() * 0.2f);
 
         // 生成相近但不同的辅色
-        float hueOffset = (dis(gen) * 0.25f) - 0.125f; // 更大的偏移范围
-        float satOffset = (dis(gen) * 0.2f) - 0.1f;
-        float valOffset = (dis(gen) * 0.2f) - 0.1f;
+        float hueOffset = (inputRandom.uniform() * 0.25f) - 0.125f; // 更大的偏移范围
+        float satOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
+        float valOffset = (inputRandom.uniform() * 0.2f) - 0.1f;
 
         glm::vec4 secondaryColor = HSVtoRGB(fmod(hue + hueOffset + 1.0f, 1.0f),
             glm::clamp(primaryColor.g + satOffset, 0.6f, 1.0f),
@@ -650,16 +629,11 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
             launchPosition.z = dir.y;
         }
 
-        // 添加随机数生成器用于随机效果
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_real_distribution<float> dis(0.0f, 1.0f);
-
         // 随机生命周期：0.8-1.2秒，控制爆炸高度
-        float randomLife = 0.8f + dis(gen) * 0.4f;
+        float randomLife = 0.8f + inputRandom.uniform() * 0.4f;
 
         // 随机轻微颜色变化
-        float colorVariation = 0.9f + dis(gen) * 0.2f;
+        float colorVariation = 0.9f + inputRandom.uniform() * 0.2f;
         
         // 更新UI中的烟花计数
         if (uiManager) {
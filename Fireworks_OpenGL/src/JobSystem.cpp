@@ -0,0 +1,111 @@
+﻿#include "JobSystem.h"
+#include <algorithm>
+
+JobSystem::JobSystem(unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) threadCount = 1;
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    // 0 号线程为调用 run() 的线程，只需额外创建 threadCount - 1 个
+    for (unsigned i = 1; i < threadCount; ++i) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        quit = true;
+    }
+    wakeCv.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+size_t JobSystem::itemsPerJob(size_t count, size_t minPerJob) const {
+    size_t maxJobs = static_cast<size_t>(workerCount()) * 4;
+    size_t perJob = (count + maxJobs - 1) / maxJobs;
+    return (std::max)(perJob, (std::max)(minPerJob, size_t(1)));
+}
+
+void JobSystem::run(size_t jobCount, const JobFn& fn) {
+    if (jobCount == 0) return;
+
+    // 单线程或只有一个任务：直接在当前线程执行
+    if (threads.empty() || jobCount == 1) {
+        for (size_t j = 0; j < jobCount; ++j) fn(j, 0);
+        return;
+    }
+
+    // 连续的任务分给同一个线程，保持数据局部性
+    unsigned workers = workerCount();
+    remaining = jobCount;
+    current = &fn;
+    for (unsigned w = 0; w < workers; ++w) {
+        size_t begin = jobCount * w / workers;
+        size_t end = jobCount * (w + 1) / workers;
+        std::lock_guard<std::mutex> lock(queues[w]->mutex);
+        for (size_t j = begin; j < end; ++j) queues[w]->jobs.push_back(j);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        ++generation;
+    }
+    wakeCv.notify_all();
+
+    // 调用线程也参与执行
+    while (runOne(0)) {}
+
+    std::unique_lock<std::mutex> lock(stateMutex);
+    doneCv.wait(lock, [this] { return remaining.load() == 0; });
+    current = nullptr;
+}
+
+// 取一个任务并执行：先取自己队列，再从其他队列窃取；没有任务时返回 false
+bool JobSystem::runOne(unsigned worker) {
+    size_t job = 0;
+    bool found = false;
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = own.jobs.front();
+            own.jobs.pop_front();
+            found = true;
+        }
+    }
+    unsigned workers = workerCount();
+    for (unsigned i = 1; !found && i < workers; ++i) {
+        Queue& victim = *queues[(worker + i) % workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.back();
+            victim.jobs.pop_back();
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    (*current)(job, worker);
+
+    if (remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        doneCv.notify_all();
+    }
+    return true;
+}
+
+void JobSystem::workerLoop(unsigned worker) {
+    size_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            wakeCv.wait(lock, [&] { return quit || generation != seenGeneration; });
+            if (quit) return;
+            seenGeneration = generation;
+        }
+        while (runOne(worker)) {}
+    }
+}
@@ -0,0 +1,135 @@
+﻿#include "ParticleBenchmark.h"
+#include "FireworkParticleSystem.h"
+#include "GpuTimer.h"
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace {
+    const uint64_t BENCH_SEED = 20240101;
+
+    // 离屏帧缓冲中被点亮的像素数（任一颜色分量非 0）
+    size_t countLitPixels(int width, int height) {
+        std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        size_t lit = 0;
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            if (pixels[i] | pixels[i + 1] | pixels[i + 2]) lit++;
+        }
+        return lit;
+    }
+
+    // 固定场景：每 20 帧一轮 8 排 × 5 列烟花（5 种内置类型轮换），共 10 轮；
+    // 按固定步长模拟 500 帧（模拟有时间缩放，此时大部分爆炸正在展开，约 6 万粒子）后冻结
+    void buildScene(FireworkParticleSystem& system) {
+        system.setSeed(BENCH_SEED);
+        const FireworkType types[] = { FireworkType::Sphere, FireworkType::Ring, FireworkType::MultiLayer, FireworkType::Spiral, FireworkType::Heart };
+        const glm::vec4 colors[] = {
+            glm::vec4(1.0f, 0.3f, 0.2f, 1.0f), glm::vec4(0.2f, 0.9f, 1.0f, 1.0f), glm::vec4(0.3f, 0.4f, 1.0f, 1.0f),
+            glm::vec4(1.0f, 0.8f, 0.2f, 1.0f), glm::vec4(1.0f, 0.4f, 0.8f, 1.0f)
+        };
+        for (int frame = 0; frame < 500; ++frame) {
+            if (frame < 200 && frame % 20 == 0) {
+                int volley = frame / 20;
+                for (int row = 0; row < 8; ++row) {
+                    for (int col = 0; col < 5; ++col) {
+                        int kind = (col + volley) % 5;
+                        glm::vec3 position(-8.0f + col * 4.0f, 0.5f, -14.0f + row * 4.0f);
+                        system.launch(position, types[kind], 1.2f + (row % 4) * 0.1f, colors[kind], colors[(kind + 2) % 5], 0.05f);
+                    }
+                }
+            }
+            system.update(1.0f / 60.0f);
+        }
+    }
+}
+
+ParticleBenchmark::Result ParticleBenchmark::run(FireworkParticleSystem& system, int width, int height, int frames) {
+    Result result;
+
+    buildScene(system);
+    result.particles = system.particleCount();
+
+    // 固定相机：与 main.cpp 的初始相机同一位置，稍微抬头看向爆炸高度
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 4.5f, 22.0f), glm::vec3(0.0f, 9.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(width) / height, 0.1f, 200.0f);
+
+    // 离屏帧缓冲：不受窗口大小和垂直同步影响
+    GLuint fbo = 0, colorTexture = 0, depthBuffer = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenTextures(1, &colorTexture);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    glViewport(0, 0, width, height);
+
+    // 画 frames 帧并返回每帧平均 GPU 耗时；wallMs 为 render() 加 glFinish 的平均墙钟时间
+    // （软件光栅化的计时查询可能在延后执行的绘制之前就结束，两者一并报告），lit 为最后一帧点亮的像素数
+    GpuTimer timer;
+    auto measure = [&](float& wallMs, size_t& lit) {
+        system.setViewProj(view, projection);
+
+        // 预热几帧（第一次绘制会创建着色器和缓冲），不计时
+        const int warmup = 5;
+        double totalMs = 0.0;
+        double totalWallMs = 0.0;
+        int timed = 0;
+        for (int frame = 0; frame < warmup + frames; ++frame) {
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            auto start = std::chrono::steady_clock::now();
+            if (frame >= warmup) timer.begin();
+            system.render();
+            if (frame >= warmup) timer.end();
+            glFinish();
+            if (frame >= warmup) totalWallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            float ms = 0.0f;
+            if (timer.poll(ms)) {
+                totalMs += ms;
+                timed++;
+            }
+        }
+        wallMs = static_cast<float>(totalWallMs / frames);
+        lit = countLitPixels(width, height);
+        return timed > 0 ? static_cast<float>(totalMs / timed) : -1.0f;
+    };
+
+    const bool wasBillboards = system.billboards;
+    system.billboards = false;
+    result.pointsMs = measure(result.pointsWallMs, result.pointsLit);
+    system.billboards = true;
+    result.billboardsMs = measure(result.billboardsWallMs, result.billboardsLit);
+    system.billboards = false;
+
+    // 解析爆炸：等上一场的粒子全部消失后打开 analyticBursts，以同一种子重放同一场景再冻结
+    // （爆炸粒子在生成时交给顶点着色器，冻结后画面只由时间决定）
+    for (int guard = 0; guard < 20000 && system.particleCount() > 0; ++guard) system.update(1.0f / 60.0f);
+    const bool wasAnalytic = system.analyticBursts;
+    system.analyticBursts = true;
+    buildScene(system);
+    result.analyticMs = measure(result.analyticWallMs, result.analyticLit);
+    system.analyticBursts = wasAnalytic;
+    system.billboards = wasBillboards;
+
+    timer.cleanupGL();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteTextures(1, &colorTexture);
+    glDeleteFramebuffers(1, &fbo);
+
+    std::cout << "[Bench] Particle paths: " << width << "x" << height << ", " << result.particles << " particles, "
+              << frames << " frames, seed " << BENCH_SEED << std::endl;
+    std::cout << "[Bench]   GL_POINTS            " << result.pointsMs << " ms/frame (gpu), " << result.pointsWallMs << " ms/frame (wall), " << result.pointsLit << " lit pixels" << std::endl;
+    std::cout << "[Bench]   instanced billboards " << result.billboardsMs << " ms/frame (gpu), " << result.billboardsWallMs << " ms/frame (wall), " << result.billboardsLit << " lit pixels" << std::endl;
+    std::cout << "[Bench]   analytic bursts      " << result.analyticMs << " ms/frame (gpu), " << result.analyticWallMs << " ms/frame (wall), " << result.analyticLit << " lit pixels" << std::endl;
+    return result;
+}
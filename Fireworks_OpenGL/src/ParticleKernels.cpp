@@ -0,0 +1,299 @@
+﻿#include "ParticleKernels.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PARTICLE_KERNELS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#include <cpuid.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace ParticleKernels {
+
+// ---------------- 标量版本（也用于处理 SIMD 循环剩余的尾部粒子） ----------------
+
+static int integrateScalar(ParticleChunk& c, int begin, float dt, float gravityStep, float drag) {
+    int killed = 0;
+    for (int i = begin; i < c.count; ++i) {
+        if (c.life[i] <= 0.0f) continue;
+        c.prevX[i] = c.posX[i];
+        c.prevY[i] = c.posY[i];
+        c.prevZ[i] = c.posZ[i];
+        c.posX[i] += c.velX[i] * dt;
+        c.posY[i] += c.velY[i] * dt;
+        c.posZ[i] += c.velZ[i] * dt;
+        c.velY[i] += gravityStep;
+        c.velX[i] *= drag; // 空气阻力
+        c.velY[i] *= drag;
+        c.velZ[i] *= drag;
+        c.life[i] -= dt;
+        if (c.life[i] <= 0.0f || c.posY[i] < 0.0f) {
+            c.life[i] = 0.0f;
+            killed++;
+        }
+    }
+    return killed;
+}
+
+static void normalizedAgeScalar(const float* life, const float* maxLife, float* out, int begin, int count) {
+    for (int i = begin; i < count; ++i) {
+        out[i] = 1.0f - life[i] / maxLife[i];
+    }
+}
+
+static float maxTrailMoveSqScalar(const ParticleChunk& c, int slot, int begin, float best) {
+    const float* tx = c.trailX[slot];
+    const float* ty = c.trailY[slot];
+    const float* tz = c.trailZ[slot];
+    for (int i = begin; i < c.count; ++i) {
+        float dx = c.posX[i] - tx[i];
+        float dy = c.posY[i] - ty[i];
+        float dz = c.posZ[i] - tz[i];
+        best = (std::max)(best, dx * dx + dy * dy + dz * dz);
+    }
+    return best;
+}
+
+#ifdef PARTICLE_KERNELS_X86
+
+// 4 位掩码中置位的个数
+static const int kBitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+// ---------------- SSE2：一次处理 4 个粒子 ----------------
+// 死亡粒子所在的通道照常计算，但用掩码选回原值再写回，效果等同于标量版本的 continue
+
+static inline __m128 select128(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void integrateSSE2(ParticleChunk& c, float dt, float gravityStep, float drag) {
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vgrav = _mm_set1_ps(gravityStep);
+    const __m128 vdrag = _mm_set1_ps(drag);
+    const __m128 zero = _mm_setzero_ps();
+    int killed = 0;
+    int i = 0;
+    for (; i + 4 <= c.count; i += 4) {
+        __m128 life = _mm_load_ps(c.life + i);
+        __m128 alive = _mm_cmpnle_ps(life, zero);
+        if (_mm_movemask_ps(alive) == 0) continue;
+
+        __m128 vx = _mm_load_ps(c.velX + i);
+        __m128 vy = _mm_load_ps(c.velY + i);
+        __m128 vz = _mm_load_ps(c.velZ + i);
+        __m128 px = _mm_load_ps(c.posX + i);
+        __m128 py = _mm_load_ps(c.posY + i);
+        __m128 pz = _mm_load_ps(c.posZ + i);
+
+        __m128 npx = _mm_add_ps(px, _mm_mul_ps(vx, vdt));
+        __m128 npy = _mm_add_ps(py, _mm_mul_ps(vy, vdt));
+        __m128 npz = _mm_add_ps(pz, _mm_mul_ps(vz, vdt));
+        __m128 nvx = _mm_mul_ps(vx, vdrag);
+        __m128 nvy = _mm_mul_ps(_mm_add_ps(vy, vgrav), vdrag);
+        __m128 nvz = _mm_mul_ps(vz, vdrag);
+        __m128 nlife = _mm_sub_ps(life, vdt);
+
+        __m128 dies = _mm_and_ps(alive, _mm_or_ps(_mm_cmple_ps(nlife, zero), _mm_cmplt_ps(npy, zero)));
+        nlife = _mm_andnot_ps(dies, nlife);
+        killed += kBitCount[_mm_movemask_ps(dies)];
+
+        _mm_store_ps(c.prevX + i, px); // 死亡粒子的 prev 不会被读取，无需按掩码选择
+        _mm_store_ps(c.prevY + i, py);
+        _mm_store_ps(c.prevZ + i, pz);
+        _mm_store_ps(c.posX + i, select128(alive, npx, px));
+        _mm_store_ps(c.posY + i, select128(alive, npy, py));
+        _mm_store_ps(c.posZ + i, select128(alive, npz, pz));
+        _mm_store_ps(c.velX + i, select128(alive, nvx, vx));
+        _mm_store_ps(c.velY + i, select128(alive, nvy, vy));
+        _mm_store_ps(c.velZ + i, select128(alive, nvz, vz));
+        _mm_store_ps(c.life + i, select128(alive, nlife, life));
+    }
+    killed += integrateScalar(c, i, dt, gravityStep, drag);
+    c.aliveCount -= killed;
+}
+
+static void normalizedAgeSSE2(const float* life, const float* maxLife, float* out, int count) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 ratio = _mm_div_ps(_mm_load_ps(life + i), _mm_load_ps(maxLife + i));
+        _mm_store_ps(out + i, _mm_sub_ps(one, ratio));
+    }
+    normalizedAgeScalar(life, maxLife, out, i, count);
+}
+
+static float maxTrailMoveSqSSE2(const ParticleChunk& c, int slot) {
+    __m128 best = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= c.count; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_load_ps(c.posX + i), _mm_load_ps(c.trailX[slot] + i));
+        __m128 dy = _mm_sub_ps(_mm_load_ps(c.posY + i), _mm_load_ps(c.trailY[slot] + i));
+        __m128 dz = _mm_sub_ps(_mm_load_ps(c.posZ + i), _mm_load_ps(c.trailZ[slot] + i));
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        best = _mm_max_ps(best, d2);
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, best);
+    float result = (std::max)((std::max)(lanes[0], lanes[1]), (std::max)(lanes[2], lanes[3]));
+    return maxTrailMoveSqScalar(c, slot, i, result);
+}
+
+// ---------------- AVX2：一次处理 8 个粒子 ----------------
+
+TARGET_AVX2 static void integrateAVX2(ParticleChunk& c, float dt, float gravityStep, float drag) {
+    const __m256 vdt = _mm256_set1_ps(dt);
+    const __m256 vgrav = _mm256_set1_ps(gravityStep);
+    const __m256 vdrag = _mm256_set1_ps(drag);
+    const __m256 zero = _mm256_setzero_ps();
+    int killed = 0;
+    int i = 0;
+    for (; i + 8 <= c.count; i += 8) {
+        __m256 life = _mm256_load_ps(c.life + i);
+        __m256 alive = _mm256_cmp_ps(life, zero, _CMP_NLE_UQ);
+        if (_mm256_movemask_ps(alive) == 0) continue;
+
+        __m256 vx = _mm256_load_ps(c.velX + i);
+        __m256 vy = _mm256_load_ps(c.velY + i);
+        __m256 vz = _mm256_load_ps(c.velZ + i);
+        __m256 px = _mm256_load_ps(c.posX + i);
+        __m256 py = _mm256_load_ps(c.posY + i);
+        __m256 pz = _mm256_load_ps(c.posZ + i);
+
+        __m256 npx = _mm256_add_ps(px, _mm256_mul_ps(vx, vdt));
+        __m256 npy = _mm256_add_ps(py, _mm256_mul_ps(vy, vdt));
+        __m256 npz = _mm256_add_ps(pz, _mm256_mul_ps(vz, vdt));
+        __m256 nvx = _mm256_mul_ps(vx, vdrag);
+        __m256 nvy = _mm256_mul_ps(_mm256_add_ps(vy, vgrav), vdrag);
+        __m256 nvz = _mm256_mul_ps(vz, vdrag);
+        __m256 nlife = _mm256_sub_ps(life, vdt);
+
+        __m256 dies = _mm256_and_ps(alive, _mm256_or_ps(_mm256_cmp_ps(nlife, zero, _CMP_LE_OQ),
+                                                        _mm256_cmp_ps(npy, zero, _CMP_LT_OQ)));
+        nlife = _mm256_andnot_ps(dies, nlife);
+        int dieBits = _mm256_movemask_ps(dies);
+        killed += kBitCount[dieBits & 15] + kBitCount[dieBits >> 4];
+
+        _mm256_store_ps(c.prevX + i, px);
+        _mm256_store_ps(c.prevY + i, py);
+        _mm256_store_ps(c.prevZ + i, pz);
+        _mm256_store_ps(c.posX + i, _mm256_blendv_ps(px, npx, alive));
+        _mm256_store_ps(c.posY + i, _mm256_blendv_ps(py, npy, alive));
+        _mm256_store_ps(c.posZ + i, _mm256_blendv_ps(pz, npz, alive));
+        _mm256_store_ps(c.velX + i, _mm256_blendv_ps(vx, nvx, alive));
+        _mm256_store_ps(c.velY + i, _mm256_blendv_ps(vy, nvy, alive));
+        _mm256_store_ps(c.velZ + i, _mm256_blendv_ps(vz, nvz, alive));
+        _mm256_store_ps(c.life + i, _mm256_blendv_ps(life, nlife, alive));
+    }
+    // 尾部走 SSE 编码的标量代码，先清掉 YMM 高半部分以免 AVX-SSE 切换惩罚
+    _mm256_zeroupper();
+    killed += integrateScalar(c, i, dt, gravityStep, drag);
+    c.aliveCount -= killed;
+}
+
+TARGET_AVX2 static void normalizedAgeAVX2(const float* life, const float* maxLife, float* out, int count) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 ratio = _mm256_div_ps(_mm256_load_ps(life + i), _mm256_load_ps(maxLife + i));
+        _mm256_store_ps(out + i, _mm256_sub_ps(one, ratio));
+    }
+    _mm256_zeroupper();
+    normalizedAgeScalar(life, maxLife, out, i, count);
+}
+
+TARGET_AVX2 static float maxTrailMoveSqAVX2(const ParticleChunk& c, int slot) {
+    __m256 best = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= c.count; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_load_ps(c.posX + i), _mm256_load_ps(c.trailX[slot] + i));
+        __m256 dy = _mm256_sub_ps(_mm256_load_ps(c.posY + i), _mm256_load_ps(c.trailY[slot] + i));
+        __m256 dz = _mm256_sub_ps(_mm256_load_ps(c.posZ + i), _mm256_load_ps(c.trailZ[slot] + i));
+        __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        best = _mm256_max_ps(best, d2);
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, best);
+    _mm256_zeroupper();
+    float result = 0.0f;
+    for (float lane : lanes) result = (std::max)(result, lane);
+    return maxTrailMoveSqScalar(c, slot, i, result);
+}
+
+static bool cpuHasAVX2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false; // 操作系统需保存 YMM 寄存器
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // PARTICLE_KERNELS_X86
+
+Level bestLevel() {
+#ifdef PARTICLE_KERNELS_X86
+    static const Level level = cpuHasAVX2() ? Level::AVX2 : Level::SSE2;
+    return level;
+#else
+    return Level::Scalar;
+#endif
+}
+
+const char* levelName(Level level) {
+    switch (level) {
+    case Level::AVX2: return "AVX2";
+    case Level::SSE2: return "SSE2";
+    default: return "Scalar";
+    }
+}
+
+// 请求的级别超过 CPU 支持时降级，避免执行非法指令
+static Level clampLevel(Level level) {
+    return (level > bestLevel()) ? bestLevel() : level;
+}
+
+void integrate(Level level, ParticleChunk& c, float dt, float gravityStep, float drag) {
+    switch (clampLevel(level)) {
+#ifdef PARTICLE_KERNELS_X86
+    case Level::AVX2: integrateAVX2(c, dt, gravityStep, drag); return;
+    case Level::SSE2: integrateSSE2(c, dt, gravityStep, drag); return;
+#endif
+    default: c.aliveCount -= integrateScalar(c, 0, dt, gravityStep, drag); return;
+    }
+}
+
+void normalizedAge(Level level, const float* life, const float* maxLife, float* out, int count) {
+    switch (clampLevel(level)) {
+#ifdef PARTICLE_KERNELS_X86
+    case Level::AVX2: normalizedAgeAVX2(life, maxLife, out, count); return;
+    case Level::SSE2: normalizedAgeSSE2(life, maxLife, out, count); return;
+#endif
+    default: normalizedAgeScalar(life, maxLife, out, 0, count); return;
+    }
+}
+
+float maxTrailMoveSq(Level level, const ParticleChunk& c, int slot) {
+    switch (clampLevel(level)) {
+#ifdef PARTICLE_KERNELS_X86
+    case Level::AVX2: return maxTrailMoveSqAVX2(c, slot);
+    case Level::SSE2: return maxTrailMoveSqSSE2(c, slot);
+#endif
+    default: return maxTrailMoveSqScalar(c, slot, 0, 0.0f);
+    }
+}
+
+}
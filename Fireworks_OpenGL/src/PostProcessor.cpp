@@ -7,10 +7,11 @@ static const char* bloomVertexSrc = "assets/shaders/bloom.vs";
 static const char* bloomFragmentSrc = "assets/shaders/bloom.fs";
 static const char* blurVertexSrc = "assets/shaders/blur.vs";
 static const char* blurFragmentSrc = "assets/shaders/blur.fs";
+static const char* upsampleFragmentSrc = "assets/shaders/particle_upsample.fs";
 
 PostProcessor::PostProcessor(unsigned int w, unsigned int h)
-: FBO(0), RBO(0), textureColorBuffer(0), quadVAO(0), quadVBO(0),
-  width(w), height(h),
+: FBO(0), depthTexture(0), textureColorBuffer(0), quadVAO(0), quadVBO(0),
+  width(w), height(h), renderWidth(w), renderHeight(h),
   postShader(nullptr),
   bloomShader(nullptr),
   blurShader(nullptr),
@@ -29,6 +30,7 @@ PostProcessor::PostProcessor(unsigned int w, unsigned int h)
         postShader  = new Shader(defaultVertexSrc, defaultFragmentSrc);
         bloomShader = new Shader(bloomVertexSrc, bloomFragmentSrc);
         blurShader  = new Shader(blurVertexSrc, blurFragmentSrc);
+        upsampleShader = new Shader(defaultVertexSrc, upsampleFragmentSrc);
         
         // ʼ֡塢ȾݡBloom
         initFramebuffer();
@@ -40,6 +42,7 @@ PostProcessor::PostProcessor(unsigned int w, unsigned int h)
         if (postShader) { delete postShader; postShader = nullptr; }
         if (bloomShader) { delete bloomShader; bloomShader = nullptr; }
         if (blurShader) { delete blurShader; blurShader = nullptr; }
+        if (upsampleShader) { delete upsampleShader; upsampleShader = nullptr; }
         throw;
     }
 }
@@ -47,7 +50,7 @@ PostProcessor::PostProcessor(unsigned int w, unsigned int h)
 PostProcessor::~PostProcessor()
 {
     std::cout << "~PostProcessor --> quadVAO = " << quadVAO << ", quadVBO = " << quadVBO
-        << ", textureColorBuffer = " << textureColorBuffer << ", RBO = " << RBO << ", FBO = " << FBO << std::endl;
+        << ", textureColorBuffer = " << textureColorBuffer << ", depthTexture = " << depthTexture << ", FBO = " << FBO << std::endl;
     
     // ɾ Shaderɾ OpenGL Դ֮ǰ
     if (postShader) {
@@ -65,6 +68,10 @@ PostProcessor::~PostProcessor()
         blurShader = nullptr;
         std::cout << "Delete blurShader" << std::endl;
     }
+    if (upsampleShader) {
+        delete upsampleShader;
+        upsampleShader = nullptr;
+    }
     
     // Ȼɾ OpenGL Դ
     if (quadVBO) {
@@ -82,10 +89,10 @@ PostProcessor::~PostProcessor()
         textureColorBuffer = 0;
         std::cout << "Delete textureColorBuffer" << std::endl;
     }
-    if (RBO) {
-        glDeleteRenderbuffers(1, &RBO);
-        RBO = 0;
-        std::cout << "Delete RBO" << std::endl;
+    if (depthTexture) {
+        glDeleteTextures(1, &depthTexture);
+        depthTexture = 0;
+        std::cout << "Delete depthTexture" << std::endl;
     }
     if (FBO) {
         glDeleteFramebuffers(1, &FBO);
@@ -105,6 +112,8 @@ PostProcessor::~PostProcessor()
     }
 
     std::cout << "Delete pingpong and pingpongColorBuffer" << std::endl;
+
+    releaseParticleBuffers();
 }
 
 void PostProcessor::initFramebuffer()
@@ -119,7 +128,7 @@ void PostProcessor::initFramebuffer()
     // std::cout << "textureColorbuffer: " << textureColorBuffer << std::endl;
 
     // Use HDR (float) render target so bright values are preserved for bloom
-    glTexImage2D(GL_TEXTURE_2D,0, GL_RGBA16F, width, height,0, GL_RGBA, GL_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D,0, GL_RGBA16F, renderWidth, renderHeight,0, GL_RGBA, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
@@ -132,11 +141,15 @@ void PostProcessor::initFramebuffer()
     GLenum drawBuffers[1] = {GL_COLOR_ATTACHMENT0};
     glDrawBuffers(1, drawBuffers);
 
-    // Ⱦ + ģ壩
-    glGenRenderbuffers(1, &RBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, RBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, RBO);
+    //  + ģȾ壺ͷֱӺϳʱҪȡȣ
+    glGenTextures(1, &depthTexture);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, renderWidth, renderHeight, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
 
     // FBO
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
@@ -197,7 +210,7 @@ void PostProcessor::initBloomBuffers()
 		 // ʼFBO + color attachment
 		 glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[i]);
 		 glBindTexture(GL_TEXTURE_2D, pingpongColorBuffers[i]);
-		 glTexImage2D(GL_TEXTURE_2D,0, GL_RGBA16F, width, height,0, GL_RGBA, GL_FLOAT, NULL);
+		 glTexImage2D(GL_TEXTURE_2D,0, GL_RGBA16F, renderWidth, renderHeight,0, GL_RGBA, GL_FLOAT, NULL);
 		 
 		 // ͼģʽ Wrap ģʽ --> clamp to edge to prevent artifacts
 		 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -224,7 +237,7 @@ void PostProcessor::Bind()
 	// std::cout << "Bind PostProcessor" << std::endl;
 	if (!glIsFramebuffer(FBO)) std::cerr << "[PostProcessor::Bind] Warning: FBO not valid!" << std::endl;
 	 glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-	 glViewport(0,0, width, height);
+	 glViewport(0,0, renderWidth, renderHeight);
 }
 
 void PostProcessor::Unbind()
@@ -257,7 +270,7 @@ void PostProcessor::applyBloom()
 
 	// ------------------ Step 1: ȡ ------------------
 	glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[0]);
-	glViewport(0, 0, width, height);
+	glViewport(0, 0, renderWidth, renderHeight);
 	bloomShader->use();
 	bloomShader->setInt("scene", 0);
 	glActiveTexture(GL_TEXTURE0);
@@ -269,7 +282,6 @@ void PostProcessor::applyBloom()
 
 	// ------------------ Step 2: ˹ģping-pong ------------------
 	bool horizontal = true;
-	int blurPasses = 8;  // ģЧ
 	int readTex = 0; // ʼȡ pingpongColorBuffers[0]
 
 	for (int i = 0; i < blurPasses; ++i) {
@@ -285,7 +297,7 @@ void PostProcessor::applyBloom()
 		}
 
 		glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[writeFBO]);
-		glViewport(0, 0, width, height);
+		glViewport(0, 0, renderWidth, renderHeight);
 
 		blurShader->use();
 		blurShader->setInt("horizontal", horizontal);
@@ -306,6 +318,161 @@ void PostProcessor::applyBloom()
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+// ı䳡Ⱦֱʣ´СؽͻԹ֡
+void PostProcessor::SetRenderScale(float scale)
+{
+	scale = scale < 0.25f ? 0.25f : (scale > 1.0f ? 1.0f : scale);
+	unsigned int w = (unsigned int)(width * scale + 0.5f);
+	unsigned int h = (unsigned int)(height * scale + 0.5f);
+	renderScale = scale;
+	if (w == renderWidth && h == renderHeight) return;
+
+	renderWidth = w > 0 ? w : 1;
+	renderHeight = h > 0 ? h : 1;
+	releaseBuffers();
+	initFramebuffer();
+	initBloomBuffers();
+	lastBlurTextureIndex = -1;
+	std::cout << "[PostProcessor] Render resolution " << renderWidth << "x" << renderHeight << std::endl;
+}
+
+void PostProcessor::releaseBuffers()
+{
+	if (textureColorBuffer) {
+		glDeleteTextures(1, &textureColorBuffer);
+		textureColorBuffer = 0;
+	}
+	if (depthTexture) {
+		glDeleteTextures(1, &depthTexture);
+		depthTexture = 0;
+	}
+	if (FBO) {
+		glDeleteFramebuffers(1, &FBO);
+		FBO = 0;
+	}
+	glDeleteFramebuffers(2, pingpongFBO);
+	glDeleteTextures(2, pingpongColorBuffers);
+	pingpongFBO[0] = pingpongFBO[1] = 0;
+	pingpongColorBuffers[0] = pingpongColorBuffers[1] = 0;
+	releaseParticleBuffers(); // ӻС泡֡壬´ʹʱؽ
+}
+
+// ıӻֱʣ´ BeginParticles ʱ´Сؽ
+void PostProcessor::SetParticleResolution(float scale)
+{
+	scale = scale < 0.25f ? 0.25f : (scale > 1.0f ? 1.0f : scale);
+	if (scale == particleResolution) return;
+	particleResolution = scale;
+	releaseParticleBuffers();
+}
+
+void PostProcessor::initParticleBuffers()
+{
+	particleWidth = (unsigned int)(renderWidth * particleResolution + 0.5f);
+	particleHeight = (unsigned int)(renderHeight * particleResolution + 0.5f);
+	if (particleWidth == 0) particleWidth = 1;
+	if (particleHeight == 0) particleHeight = 1;
+
+	glGenFramebuffers(1, &particleFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, particleFBO);
+
+	// ɫHDR˫Զȡƽ̹ϲ
+	glGenTextures(1, &particleColorBuffer);
+	glBindTexture(GL_TEXTURE_2D, particleColorBuffer);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, particleWidth, particleHeight, 0, GL_RGBA, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, particleColorBuffer, 0);
+
+	// Сĳȣʽ볡ͬ glBlitFramebuffer 
+	glGenTextures(1, &particleDepthBuffer);
+	glBindTexture(GL_TEXTURE_2D, particleDepthBuffer);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, particleWidth, particleHeight, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, particleDepthBuffer, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cerr << "[PostProcessor] Particle framebuffer not complete!" << std::endl;
+
+	// ϳõֻ֡ҳɫ
+	glGenFramebuffers(1, &compositeFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, compositeFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureColorBuffer, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cerr << "[PostProcessor] Composite framebuffer not complete!" << std::endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	std::cout << "[PostProcessor] Particle resolution " << particleWidth << "x" << particleHeight << std::endl;
+}
+
+void PostProcessor::releaseParticleBuffers()
+{
+	if (particleColorBuffer) glDeleteTextures(1, &particleColorBuffer);
+	if (particleDepthBuffer) glDeleteTextures(1, &particleDepthBuffer);
+	if (particleFBO) glDeleteFramebuffers(1, &particleFBO);
+	if (compositeFBO) glDeleteFramebuffers(1, &compositeFBO);
+	particleColorBuffer = particleDepthBuffer = 0;
+	particleFBO = compositeFBO = 0;
+}
+
+// лͷֱӻ壺Сĳȣֻ NEAREST ƣɫ
+void PostProcessor::BeginParticles()
+{
+	if (particleResolution >= 1.0f) return;
+	if (!particleFBO) initParticleBuffers();
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, particleFBO);
+	glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, particleWidth, particleHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, particleFBO);
+	glViewport(0, 0, particleWidth, particleHeight);
+	GLfloat clearColor[4];
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+}
+
+// ӻԤ alpha  over ϺϳɻسɫȻص֡
+void PostProcessor::EndParticles()
+{
+	if (particleResolution >= 1.0f || !particleFBO) return;
+
+	GLboolean depthWasEnabled = glIsEnabled(GL_DEPTH_TEST);
+	GLboolean blendWasEnabled = glIsEnabled(GL_BLEND);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, compositeFBO);
+	glViewport(0, 0, renderWidth, renderHeight);
+	upsampleShader->use();
+	upsampleShader->setInt("particles", 0);
+	upsampleShader->setInt("particleDepth", 1);
+	upsampleShader->setInt("sceneDepth", 2);
+	upsampleShader->setVec2("depthRange", depthNear, depthFar);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, particleColorBuffer);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, particleDepthBuffer);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, depthTexture);
+	glBindVertexArray(quadVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+	glBindVertexArray(0);
+	glActiveTexture(GL_TEXTURE0);
+
+	if (depthWasEnabled) glEnable(GL_DEPTH_TEST);
+	if (!blendWasEnabled) glDisable(GL_BLEND);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+}
+
 // õ뵭͸
 void PostProcessor::SetFadeAlpha(float alpha)
 {
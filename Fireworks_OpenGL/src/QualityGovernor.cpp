@@ -0,0 +1,52 @@
+﻿#include "QualityGovernor.h"
+#include <algorithm>
+#include <iostream>
+
+QualityGovernor::QualityGovernor() {
+    // 先减拖尾和辉光（对画面影响小），再减粒子数、把粒子画进半分辨率缓冲，最后降低场景分辨率
+    levels = {
+        { 1.0f,  1, 8, 1.0f,  1.0f },
+        { 1.0f,  2, 6, 1.0f,  1.0f },
+        { 0.8f,  2, 4, 1.0f,  0.5f },
+        { 0.65f, 3, 4, 0.85f, 0.5f },
+        { 0.5f,  3, 2, 0.75f, 0.5f },
+        { 0.35f, 4, 2, 0.6f,  0.5f },
+    };
+}
+
+bool QualityGovernor::update(float deltaTime, float cpuMs, float gpuMs) {
+    cpuAverage += (cpuMs - cpuAverage) * smoothing;
+    if (gpuMs >= 0.0f) gpuAverage += (gpuMs - gpuAverage) * smoothing;
+    if (!enabled) return false;
+
+    // 帧时间按较慢的一方计算：CPU 和 GPU 并行工作，瓶颈决定帧率
+    float frameMs = (std::max)(cpuAverage, gpuAverage);
+    int previous = current;
+
+    if (frameMs > budgetMs) {
+        overTime += deltaTime;
+        underTime = 0.0f;
+        if (overTime >= downshiftSeconds && current + 1 < levelCount()) {
+            current++;
+            overTime = 0.0f;
+        }
+    }
+    else if (frameMs < budgetMs * upshiftRatio) {
+        underTime += deltaTime;
+        overTime = 0.0f;
+        if (underTime >= upshiftSeconds && current > 0) {
+            current--;
+            underTime = 0.0f;
+        }
+    }
+    else {
+        // 处于迟滞区间：保持当前级别
+        overTime = 0.0f;
+        underTime = 0.0f;
+    }
+
+    if (current == previous) return false;
+    std::cout << "[Quality] Level " << current << "/" << levelCount() - 1
+              << " (cpu " << cpuAverage << " ms, gpu " << gpuAverage << " ms, budget " << budgetMs << " ms)" << std::endl;
+    return true;
+}
@@ -0,0 +1,97 @@
+﻿#include "ShapeTemplates.h"
+#include "FastRandom.h"
+#include <cmath>
+
+static const float PI = 3.14159265f;
+
+ShapeTemplates::ShapeTemplates() {
+    // 与原先逐粒子生成的分布相同：theta 均匀、cos(phi) 均匀，即球面均匀分布
+    FastRandom rng(0x5348415045ull); // 固定种子，方向表与演出种子无关
+    sphere.velocity.resize(SPHERE_DIRECTIONS);
+    sphere.angle.resize(SPHERE_DIRECTIONS);
+    for (uint32_t k = 0; k < SPHERE_DIRECTIONS; ++k) {
+        float theta = rng.uniform() * 2.0f * PI;
+        float phi = acos(2.0f * rng.uniform() - 1.0f);
+        sphere.velocity[k] = glm::vec3(sin(phi) * cos(theta), sin(phi) * sin(theta), cos(phi));
+        sphere.angle[k] = theta;
+    }
+}
+
+ShapeView ShapeTemplates::view(ShapeKind kind, int count) {
+    const ShapeTemplate* t = nullptr;
+    uint32_t mask = 0xFFFFFFFFu; // 按粒子数建表的模板：下标本身就在范围内
+    switch (kind) {
+    case ShapeKind::Sphere:
+        t = &sphere;
+        mask = SPHERE_DIRECTIONS - 1;
+        break;
+    case ShapeKind::Ring:
+        t = &ring(count);
+        break;
+    case ShapeKind::Spiral:
+        t = &spiral(count);
+        break;
+    case ShapeKind::Heart:
+        t = &heart(count);
+        break;
+    default:
+        return ShapeView();
+    }
+    ShapeView v;
+    v.velocity = t->velocity.data();
+    v.angle = t->angle.data();
+    v.mask = mask;
+    return v;
+}
+
+const ShapeTemplate& ShapeTemplates::ring(int count) {
+    auto it = rings.find(count);
+    if (it != rings.end()) return it->second;
+
+    ShapeTemplate& t = rings[count];
+    t.velocity.resize(count);
+    t.angle.resize(count);
+    for (int i = 0; i < count; ++i) {
+        float angle = (float)i / count * 2.0f * PI;
+        t.velocity[i] = glm::vec3(cos(angle), 0.0f, sin(angle));
+        t.angle[i] = angle;
+    }
+    return t;
+}
+
+const ShapeTemplate& ShapeTemplates::spiral(int count) {
+    auto it = spirals.find(count);
+    if (it != spirals.end()) return it->second;
+
+    ShapeTemplate& t = spirals[count];
+    t.velocity.resize(count);
+    t.angle.resize(count);
+    int arms = 3; // 3条螺旋线
+    for (int i = 0; i < count; ++i) {
+        float baseAngle = (float)(i % arms) / arms * 2.0f * PI;
+        float angleOffset = (float)i / count * 4.0f * PI; // 多圈螺旋
+        float angle = baseAngle + angleOffset;
+        float r = (0.4f + (float)i / count * 0.8f) * 0.8f; // 半径逐渐增大
+        t.velocity[i] = glm::vec3(cos(angle) * r, 0.0f, sin(angle) * r);
+        t.angle[i] = angle;
+    }
+    return t;
+}
+
+const ShapeTemplate& ShapeTemplates::heart(int count) {
+    auto it = hearts.find(count);
+    if (it != hearts.end()) return it->second;
+
+    ShapeTemplate& t = hearts[count];
+    t.velocity.resize(count);
+    t.angle.resize(count);
+    for (int i = 0; i < count; ++i) {
+        float a = (float)i / count * 2.0f * PI;
+        // 心形参数方程，缩放到半径 1（原先为 0.15 * radiusScale / 3）
+        float x = 16.0f * pow(sin(a), 3);
+        float y = 13.0f * cos(a) - 5.0f * cos(2.0f * a) - 2.0f * cos(3.0f * a) - cos(4.0f * a);
+        t.velocity[i] = glm::vec3(x, y, 0.0f) * 0.05f;
+        t.angle[i] = a;
+    }
+    return t;
+}
@@ -0,0 +1,374 @@
+﻿#include "ShellCatalog.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+
+// 描述格式（每行一条，# 之后为注释）：
+//   ramp <名称> <年龄>:<r>,<g>,<b>[,<白>] ...                 颜色渐变（在 shell 之外定义，先定义后引用）
+//   shell <名称> [type=sphere|ring|multilayer|spiral|heart|image]
+//   stage [delay=<秒>] [color=primary|secondary|white]        爆炸后 delay 秒执行的一组发射
+//   emit <sphere|ring|spiral|heart|image> [键=值 ...]          在当前阶段发射一组粒子
+//   end
+// emit 可用的键（省略时取 SpawnOp 的默认值）：
+//   count=<1~65536> radius=<r> radial=<基数>,<抖动> lift=x,y,z jitter=x,y,z speed=<s>
+//   life=<基数>,<抖动> size=<相对 childSize 的倍数> tint=r,g,b spin=<角速度>
+//   tail=0|1 color=primary|secondary|white ramp=<渐变名称>
+//   sub=<烟花名称> subat=<秒>      子发射：每个粒子在 subat 秒（省略或 0 = 寿命结束时）按子烟花爆开；
+//                                  子烟花需先定义（不能引用自身，因此不会无限递归）；
+//                                  图片粒子的子烟花以白色为主色
+// 以下内置描述与原先硬编码的 generate* 参数一致
+static const char* BUILTIN_SHELLS = R"(
+# 颜色渐变：fade 为默认渐变（前 85% 的生命保持原色，最后 15% 淡出）
+ramp fade 0:1,1,1 0.85:1,1,1 1:0,0,0
+# 出生时白热闪光，随后回到原色
+ramp flash 0:1.5,1.5,1.5,1 0.12:1,1,1,0 0.85:1,1,1 1:0,0,0
+# 逐渐冷却成橙红色的余烬
+ramp ember 0:1,1,1 0.45:1,0.8,0.55 0.85:0.9,0.4,0.15 1:0,0,0
+
+shell sphere type=sphere
+stage delay=0 color=primary
+emit sphere count=150 radius=4 radial=1.5,0.15 speed=2 life=0.4,0.15
+stage delay=0.1 color=secondary
+emit sphere count=90 radius=5 radial=1.5,0.15 speed=2 life=0.4,0.15
+end
+
+shell ring type=ring
+stage delay=0 color=primary
+emit ring count=150 radius=3.5 radial=0.9,0.2 lift=0,0.5,0 jitter=0,0.5,0 speed=2 life=0.35,0.15
+stage delay=0.1 color=secondary
+emit ring count=90 radius=5 radial=0.9,0.2 lift=0,0.5,0 jitter=0,0.5,0 speed=2 life=0.35,0.15
+end
+
+# 三层球：外层更大、寿命更长、颜色略有偏移
+shell multilayer type=multilayer
+stage delay=0 color=primary
+emit sphere count=50 radius=2.4 speed=2.2 life=0.4,0.15
+emit sphere count=50 radius=3.3 speed=2.2 life=0.5,0.15 size=1.02 tint=0.8,1.2,0.9
+emit sphere count=50 radius=4.2 speed=2.2 life=0.6,0.15 size=1.04 tint=1.2,0.9,1.1
+stage delay=0.1 color=secondary
+emit sphere count=30 radius=4 speed=2.2 life=0.4,0.15
+emit sphere count=30 radius=5.5 speed=2.2 life=0.5,0.15 size=1.02 tint=0.8,1.2,0.9
+emit sphere count=30 radius=7 speed=2.2 life=0.6,0.15 size=1.04 tint=1.2,0.9,1.1
+end
+
+shell spiral type=spiral
+stage delay=0 color=primary
+emit spiral count=150 radius=4 lift=0,1.5,0 jitter=0,0.5,0 speed=2 life=0.45,0.15 spin=3
+stage delay=0.1 color=secondary
+emit spiral count=90 radius=5 lift=0,1.5,0 jitter=0,0.5,0 speed=2 life=0.45,0.15 spin=3
+end
+
+# 心形烟花没有第二次爆炸
+shell heart type=heart
+stage delay=0 color=primary
+emit heart count=150 radius=3 lift=0,1,-0.25 jitter=0.3,0.3,0.5 speed=3.2 life=0.45,0.15
+end
+
+# 图片烟花：粒子数和颜色来自图片，降低亮度避免 bloom（阈值 1.5），不产生拖尾、不二次爆炸
+shell image type=image
+stage delay=0
+emit image radius=1 speed=2 life=0.8,0 size=0.0666667 tint=0.2,0.2,0.2 tail=0
+end
+)";
+
+static bool parseFloats(const std::string& text, float* out, int count) {
+    const char* p = text.c_str();
+    for (int i = 0; i < count; ++i) {
+        char* end = nullptr;
+        out[i] = std::strtof(p, &end);
+        if (end == p) return false;
+        p = end;
+        if (i + 1 < count) {
+            if (*p != ',') return false;
+            ++p;
+        }
+    }
+    return *p == '\0';
+}
+
+// 解析一个渐变关键点：<年龄>:<r>,<g>,<b>[,<白>]
+static bool parseRampKey(const std::string& text, ColorRamp::Key& out) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos || !parseFloats(text.substr(0, colon), &out.age, 1)) return false;
+    if (out.age < 0.0f || out.age > 1.0f) return false;
+    float v[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    std::string value = text.substr(colon + 1);
+    if (!parseFloats(value, v, 4) && !parseFloats(value, v, 3)) return false;
+    out.value = glm::vec4(v[0], v[1], v[2], v[3]);
+    return true;
+}
+
+glm::vec4 ColorRamp::sample(float age) const {
+    if (keys.empty()) return glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+    if (age <= keys.front().age) return keys.front().value;
+    for (size_t i = 1; i < keys.size(); ++i) {
+        if (age <= keys[i].age) {
+            const Key& a = keys[i - 1];
+            const Key& b = keys[i];
+            float span = b.age - a.age;
+            return span > 0.0f ? glm::mix(a.value, b.value, (age - a.age) / span) : b.value;
+        }
+    }
+    return keys.back().value;
+}
+
+static bool parseColor(const std::string& text, ShellColor& out) {
+    if (text == "primary") out = ShellColor::Primary;
+    else if (text == "secondary") out = ShellColor::Secondary;
+    else if (text == "white") out = ShellColor::White;
+    else return false;
+    return true;
+}
+
+static bool parseShape(const std::string& text, ShapeKind& out) {
+    if (text == "sphere") out = ShapeKind::Sphere;
+    else if (text == "ring") out = ShapeKind::Ring;
+    else if (text == "spiral") out = ShapeKind::Spiral;
+    else if (text == "heart") out = ShapeKind::Heart;
+    else if (text == "image") out = ShapeKind::Image;
+    else return false;
+    return true;
+}
+
+// 每次发射的粒子数范围：形状模板按 count 预先生成，误写的巨大数值会在加载时分配大量内存
+static const int MAX_EMIT_COUNT = 65536;
+
+// FireworkType 对应的内置描述名称（按枚举顺序）
+static const char* BUILTIN_NAMES[] = { "sphere", "ring", "multilayer", "spiral", "heart", "image" };
+
+static bool parseType(const std::string& text, FireworkType& out) {
+    for (int i = 0; i < 6; ++i) {
+        if (text == BUILTIN_NAMES[i]) {
+            out = static_cast<FireworkType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 解析一个 emit 参数（key=value）；ramp 和 sub 需要查目录，由调用方处理
+static bool parseEmitParam(const std::string& key, const std::string& value, SpawnOp& op) {
+    float v[3];
+    if (key == "radius" && parseFloats(value, v, 1)) op.radius = v[0];
+    else if (key == "radial" && parseFloats(value, v, 2)) { op.radialBase = v[0]; op.radialJitter = v[1]; }
+    else if (key == "lift" && parseFloats(value, v, 3)) op.lift = glm::vec3(v[0], v[1], v[2]);
+    else if (key == "jitter" && parseFloats(value, v, 3)) op.jitter = glm::vec3(v[0], v[1], v[2]);
+    else if (key == "speed" && parseFloats(value, v, 1)) op.speed = v[0];
+    else if (key == "life" && parseFloats(value, v, 2) && v[0] > 0.0f) { op.lifeBase = v[0]; op.lifeJitter = v[1]; }
+    else if (key == "size" && parseFloats(value, v, 1)) op.sizeScale = v[0];
+    else if (key == "tint" && parseFloats(value, v, 3)) op.tint = glm::vec3(v[0], v[1], v[2]);
+    else if (key == "spin" && parseFloats(value, v, 1)) op.spin = v[0];
+    else if (key == "subat" && parseFloats(value, v, 1) && v[0] >= 0.0f) op.subTime = v[0];
+    else if (key == "tail" && (value == "0" || value == "1")) op.tail = (value == "1");
+    else if (key == "color") return parseColor(value, op.color);
+    else return false;
+    return true;
+}
+
+ShellCatalog::ShellCatalog() {
+    loadText(BUILTIN_SHELLS, "<builtin>");
+}
+
+uint32_t ShellCatalog::find(const std::string& name) const {
+    auto it = byName.find(name);
+    return it != byName.end() ? it->second : NOT_FOUND;
+}
+
+uint32_t ShellCatalog::findRamp(const std::string& name) const {
+    auto it = rampByName.find(name);
+    return it != rampByName.end() ? it->second : NOT_FOUND;
+}
+
+std::vector<glm::vec4> ShellCatalog::bakeRamps(int width) const {
+    std::vector<glm::vec4> table(ramps.size() * width);
+    for (size_t r = 0; r < ramps.size(); ++r) {
+        for (int x = 0; x < width; ++x) {
+            float age = width > 1 ? static_cast<float>(x) / (width - 1) : 0.0f;
+            table[r * width + x] = ramps[r].sample(age);
+        }
+    }
+    return table;
+}
+
+int ShellCatalog::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "[Shells] Failed to open " << path << std::endl;
+        return 0;
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return loadText(stream.str(), path);
+}
+
+int ShellCatalog::loadText(const std::string& text, const std::string& sourceName) {
+    // 正在编译的烟花：阶段和指令先放在临时数组里，遇到 end 再整体追加，保证每种烟花的数据连续
+    struct PendingStage {
+        ShellStage stage;
+        std::vector<SpawnOp> ops;
+    };
+    bool inShell = false;
+    ShellProgram program;
+    std::vector<PendingStage> pending;
+    ShellColor stageColor = ShellColor::Primary;
+    int loaded = 0;
+
+    auto error = [&](int line, const std::string& message) {
+        std::cerr << "[Shells] " << sourceName << ":" << line << ": " << message << std::endl;
+    };
+
+    auto finish = [&]() {
+        // 阶段按 delay 排序（稳定排序，保持同一时间的书写顺序）
+        std::stable_sort(pending.begin(), pending.end(),
+            [](const PendingStage& a, const PendingStage& b) { return a.stage.delay < b.stage.delay; });
+        program.firstStage = static_cast<uint32_t>(stages.size());
+        program.stageCount = static_cast<uint32_t>(pending.size());
+        for (PendingStage& p : pending) {
+            p.stage.firstOp = static_cast<uint32_t>(ops.size());
+            p.stage.opCount = static_cast<uint32_t>(p.ops.size());
+            stages.push_back(p.stage);
+            ops.insert(ops.end(), p.ops.begin(), p.ops.end());
+        }
+        byName[program.name] = static_cast<uint32_t>(shells.size());
+        shells.push_back(program);
+        pending.clear();
+        inShell = false;
+        loaded++;
+    };
+
+    std::istringstream lines(text);
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(lines, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream tokens(line);
+        std::string keyword;
+        if (!(tokens >> keyword)) continue;
+
+        std::vector<std::pair<std::string, std::string>> params;
+        std::vector<std::string> words;
+        std::string token;
+        while (tokens >> token) {
+            size_t eq = token.find('=');
+            if (eq == std::string::npos) words.push_back(token);
+            else params.emplace_back(token.substr(0, eq), token.substr(eq + 1));
+        }
+
+        if (keyword == "ramp") {
+            if (inShell) {
+                error(lineNo, "'ramp' inside a shell");
+                continue;
+            }
+            ColorRamp ramp;
+            if (words.empty() || !params.empty()) {
+                error(lineNo, "expected 'ramp <name> <age>:<r>,<g>,<b>[,<white>] ...'");
+                continue;
+            }
+            ramp.name = words[0];
+            bool ok = true;
+            for (size_t i = 1; i < words.size() && ok; ++i) {
+                ColorRamp::Key key;
+                ok = parseRampKey(words[i], key) && (ramp.keys.empty() || key.age >= ramp.keys.back().age);
+                if (ok) ramp.keys.push_back(key);
+                else error(lineNo, "bad ramp key " + words[i]);
+            }
+            if (!ok || ramp.keys.empty()) continue;
+
+            auto it = rampByName.find(ramp.name);
+            if (it != rampByName.end()) {
+                ramps[it->second] = ramp;
+            }
+            else {
+                rampByName[ramp.name] = static_cast<uint32_t>(ramps.size());
+                ramps.push_back(ramp);
+            }
+            rampRev++;
+        }
+        else if (keyword == "shell") {
+            if (inShell) {
+                error(lineNo, "missing 'end' before new shell, closing " + program.name);
+                finish();
+            }
+            if (words.size() != 1) {
+                error(lineNo, "expected 'shell <name>'");
+                continue;
+            }
+            program = ShellProgram();
+            program.name = words[0];
+            for (auto& kv : params) {
+                if (kv.first != "type" || !parseType(kv.second, program.type)) error(lineNo, "bad shell option " + kv.first);
+            }
+            inShell = true;
+        }
+        else if (!inShell) {
+            error(lineNo, "'" + keyword + "' outside of a shell");
+        }
+        else if (keyword == "stage") {
+            PendingStage stage;
+            stageColor = ShellColor::Primary;
+            for (auto& kv : params) {
+                float v;
+                if (kv.first == "delay" && parseFloats(kv.second, &v, 1) && v >= 0.0f) stage.stage.delay = v;
+                else if (kv.first == "color" && parseColor(kv.second, stageColor)) {}
+                else error(lineNo, "bad stage option " + kv.first);
+            }
+            pending.push_back(stage);
+        }
+        else if (keyword == "emit") {
+            if (pending.empty()) {
+                error(lineNo, "'emit' before the first 'stage'");
+                continue;
+            }
+            SpawnOp op;
+            op.color = stageColor;
+            if (words.size() != 1 || !parseShape(words[0], op.shape)) {
+                error(lineNo, "expected 'emit <sphere|ring|spiral|heart|image>'");
+                continue;
+            }
+            for (auto& kv : params) {
+                if (kv.first == "ramp") {
+                    uint32_t ramp = findRamp(kv.second);
+                    if (ramp != NOT_FOUND) op.ramp = static_cast<uint16_t>(ramp);
+                    else error(lineNo, "unknown ramp " + kv.second);
+                }
+                else if (kv.first == "sub") {
+                    op.sub = find(kv.second);
+                    if (op.sub == NOT_FOUND) error(lineNo, "unknown sub shell " + kv.second + " (define it before use)");
+                }
+                else if (kv.first == "count") {
+                    float n;
+                    if (!parseFloats(kv.second, &n, 1)) {
+                        error(lineNo, "bad emit option count=" + kv.second);
+                        continue;
+                    }
+                    // 超出 1~MAX_EMIT_COUNT 时夹紧到范围内并报错（NaN 按 1 处理）
+                    op.count = n >= 1.0f ? static_cast<int>((std::min)(n, static_cast<float>(MAX_EMIT_COUNT))) : 1;
+                    if (!(n >= 1.0f && n <= MAX_EMIT_COUNT)) {
+                        error(lineNo, "count=" + kv.second + " out of range 1.." + std::to_string(MAX_EMIT_COUNT) + ", using " + std::to_string(op.count));
+                    }
+                }
+                else if (!parseEmitParam(kv.first, kv.second, op)) error(lineNo, "bad emit option " + kv.first + "=" + kv.second);
+            }
+            pending.back().ops.push_back(op);
+        }
+        else if (keyword == "end") {
+            finish();
+        }
+        else {
+            error(lineNo, "unknown keyword '" + keyword + "'");
+        }
+    }
+    if (inShell) {
+        error(lineNo, "missing 'end' at end of file, closing " + program.name);
+        finish();
+    }
+
+    // 同名描述覆盖内置描述：按类型发射（launch / forType）也使用最新加载的版本
+    for (int i = 0; i < 6; ++i) builtin[i] = find(BUILTIN_NAMES[i]);
+    return loaded;
+}
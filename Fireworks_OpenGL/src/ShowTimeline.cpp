@@ -0,0 +1,245 @@
+﻿#include "ShowTimeline.h"
+#include "FireworkSimulation.h"
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <unordered_map>
+#include <cstring>
+#include <cstdlib>
+
+static const char SHOW_MAGIC[8] = { 'F', 'W', 'S', 'H', 'O', 'W', '\0', '\0' };
+
+static bool parseFloats(const std::string& text, float* out, int count) {
+    const char* p = text.c_str();
+    for (int i = 0; i < count; ++i) {
+        char* end = nullptr;
+        out[i] = std::strtof(p, &end);
+        if (end == p) return false;
+        p = end;
+        if (i + 1 < count) {
+            if (*p != ',') return false;
+            ++p;
+        }
+    }
+    return *p == '\0';
+}
+
+int ShowTimeline::compile(const std::string& scriptPath, const std::string& timelinePath) {
+    std::ifstream script(scriptPath);
+    if (!script) {
+        std::cerr << "[Show] Failed to open " << scriptPath << std::endl;
+        return -1;
+    }
+
+    ShowHeader header = {};
+    std::memcpy(header.magic, SHOW_MAGIC, sizeof(SHOW_MAGIC));
+    header.version = ShowHeader::VERSION;
+
+    // 字符串表：烟花名称和图片路径各存一份
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> stringIndex;
+    auto intern = [&](const std::string& text) {
+        auto it = stringIndex.find(text);
+        if (it != stringIndex.end()) return it->second;
+        uint32_t index = static_cast<uint32_t>(strings.size());
+        strings.push_back(text);
+        stringIndex[text] = index;
+        return index;
+    };
+
+    std::vector<ShowCue> cues;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(script, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream tokens(line);
+        std::string first;
+        if (!(tokens >> first)) continue;
+
+        auto error = [&](const std::string& message) {
+            std::cerr << "[Show] " << scriptPath << ":" << lineNo << ": " << message << std::endl;
+        };
+
+        if (first == "seed") {
+            std::string value;
+            char* end = nullptr;
+            if (!(tokens >> value) || (std::strtoull(value.c_str(), &end, 10), *end != '\0')) {
+                error("expected 'seed <n>'");
+                continue;
+            }
+            header.seed = std::strtoull(value.c_str(), nullptr, 10);
+            header.flags |= ShowHeader::HAS_SEED;
+            continue;
+        }
+
+        ShowCue cue = {};
+        std::string shell;
+        if (!parseFloats(first, &cue.time, 1) || cue.time < 0.0f || !(tokens >> shell)) {
+            error("expected '<time> <shell> [key=value ...]'");
+            continue;
+        }
+        cue.shell = intern(shell);
+        cue.image = ShowCue::NO_STRING;
+        cue.life = 1.5f;
+        cue.size = 0.05f;
+        cue.position[0] = 0.0f; cue.position[1] = 0.5f; cue.position[2] = 0.0f;
+        std::fill_n(cue.primary, 3, 1.0f);
+        std::fill_n(cue.secondary, 3, 1.0f);
+
+        std::string token;
+        while (tokens >> token) {
+            size_t eq = token.find('=');
+            std::string key = token.substr(0, eq);
+            std::string value = eq == std::string::npos ? std::string() : token.substr(eq + 1);
+            bool ok = true;
+            if (key == "pos") ok = parseFloats(value, cue.position, 3);
+            else if (key == "color") ok = parseFloats(value, cue.primary, 3);
+            else if (key == "color2") ok = parseFloats(value, cue.secondary, 3);
+            else if (key == "life") ok = parseFloats(value, &cue.life, 1) && cue.life > 0.0f;
+            else if (key == "size") ok = parseFloats(value, &cue.size, 1);
+            else if (key == "image" && !value.empty()) cue.image = intern(value);
+            else ok = false;
+            if (!ok) error("bad cue option " + token);
+        }
+        cues.push_back(cue);
+    }
+
+    // 按时间稳定排序：同一时刻的指令保持脚本中的顺序
+    std::stable_sort(cues.begin(), cues.end(), [](const ShowCue& a, const ShowCue& b) { return a.time < b.time; });
+
+    std::string table;
+    for (const std::string& s : strings) table.append(s).push_back('\0');
+    table.resize((table.size() + 7) & ~size_t(7), '\0');
+
+    header.cueCount = static_cast<uint32_t>(cues.size());
+    header.stringCount = static_cast<uint32_t>(strings.size());
+    header.stringBytes = static_cast<uint32_t>(table.size());
+
+    std::ofstream out(timelinePath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(table.data(), table.size());
+    out.write(reinterpret_cast<const char*>(cues.data()), cues.size() * sizeof(ShowCue));
+    if (!out) {
+        std::cerr << "[Show] Failed to write " << timelinePath << std::endl;
+        return -1;
+    }
+
+    std::cout << "[Show] Compiled " << cues.size() << " cues from " << scriptPath << " to " << timelinePath << std::endl;
+    return static_cast<int>(cues.size());
+}
+
+bool ShowPlayer::open(const std::string& timelinePath) {
+    close();
+    file.open(timelinePath, std::ios::binary);
+    if (!file) {
+        std::cerr << "[Show] Failed to open " << timelinePath << std::endl;
+        return false;
+    }
+
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, SHOW_MAGIC, sizeof(SHOW_MAGIC)) != 0 || header.version != ShowHeader::VERSION) {
+        std::cerr << "[Show] " << timelinePath << " is not a show timeline (version " << ShowHeader::VERSION << ")" << std::endl;
+        close();
+        return false;
+    }
+
+    std::string table(header.stringBytes, '\0');
+    file.read(&table[0], table.size());
+    for (size_t p = 0; strings.size() < header.stringCount && p < table.size(); ) {
+        strings.emplace_back(table.c_str() + p);
+        p += strings.back().size() + 1;
+    }
+    if (!file || strings.size() != header.stringCount) {
+        std::cerr << "[Show] " << timelinePath << " has a broken string table" << std::endl;
+        close();
+        return false;
+    }
+
+    cueOffset = static_cast<std::streamoff>(sizeof(ShowHeader) + header.stringBytes);
+    block.resize(BLOCK_CUES);
+    std::cout << "[Show] Opened " << timelinePath << " (" << header.cueCount << " cues)" << std::endl;
+    return true;
+}
+
+void ShowPlayer::close() {
+    if (file.is_open()) file.close();
+    file.clear();
+    header = {};
+    strings.clear();
+    blockCount = 0;
+    cursor = 0;
+    cuesRead = 0;
+    clock = 0.0f;
+    playing = false;
+}
+
+void ShowPlayer::start(FireworkSimulation& sim) {
+    if (!file.is_open()) return;
+
+    file.clear();
+    file.seekg(cueOffset);
+    blockCount = 0;
+    cursor = 0;
+    cuesRead = 0;
+    clock = 0.0f;
+    playing = true;
+    if (header.flags & ShowHeader::HAS_SEED) sim.setSeed(header.seed);
+}
+
+// 读入下一块指令；文件读完或读取失败返回 false
+bool ShowPlayer::refill() {
+    size_t want = header.cueCount - cuesRead;
+    if (want == 0) return false;
+    if (want > BLOCK_CUES) want = BLOCK_CUES;
+
+    file.read(reinterpret_cast<char*>(block.data()), want * sizeof(ShowCue));
+    if (!file) {
+        std::cerr << "[Show] Timeline truncated after " << cuesRead << " cues" << std::endl;
+        header.cueCount = cuesRead;
+        return false;
+    }
+    blockCount = want;
+    cursor = 0;
+    cuesRead += static_cast<uint32_t>(want);
+    return true;
+}
+
+void ShowPlayer::update(float deltaTime, FireworkSimulation& sim) {
+    if (!playing) return;
+    clock += deltaTime;
+
+    // 指令已按时间排好序：从游标开始收集，遇到第一条未到时的指令即停止
+    batch.clear();
+    while (cursor < blockCount || refill()) {
+        const ShowCue& cue = block[cursor];
+        if (cue.time > clock) break;
+        cursor++;
+        if (cue.shell >= strings.size()) continue;
+
+        uint32_t shell = sim.shellCatalog().find(strings[cue.shell]);
+        if (shell == ShellCatalog::NOT_FOUND) {
+            std::cerr << "[Show] Unknown shell: " << strings[cue.shell] << std::endl;
+            continue;
+        }
+        FireworkSimulation::LaunchRequest request;
+        request.position = glm::vec3(cue.position[0], cue.position[1], cue.position[2]);
+        request.shell = shell;
+        request.life = cue.life;
+        request.primaryColor = glm::vec4(cue.primary[0], cue.primary[1], cue.primary[2], 1.0f);
+        request.secondaryColor = glm::vec4(cue.secondary[0], cue.secondary[1], cue.secondary[2], 1.0f);
+        request.size = cue.size;
+        request.imagePath = cue.image < strings.size() ? &strings[cue.image] : nullptr;
+        batch.push_back(request);
+    }
+
+    // 终场齐射等同一帧到时的多条指令一次发射
+    if (!batch.empty()) sim.launchBatch(batch.data(), batch.size());
+
+    if (finished()) {
+        playing = false;
+        std::cout << "[Show] Finished at " << clock << " s" << std::endl;
+    }
+}
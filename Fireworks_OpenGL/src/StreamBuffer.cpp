@@ -0,0 +1,71 @@
+﻿#include "StreamBuffer.h"
+#include <algorithm>
+#include <iostream>
+
+StreamBuffer::StreamBuffer(size_t framesInFlight)
+    : framesInFlight((std::max)(framesInFlight, size_t(1))) {
+}
+
+StreamBuffer::~StreamBuffer() {
+    cleanupGL();
+}
+
+void StreamBuffer::initGL(size_t initialBytes) {
+    if (vbo) return;
+
+    capacityBytes = (std::max)(initialBytes, size_t(64)) * framesInFlight;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, capacityBytes, nullptr, GL_STREAM_DRAW);
+    head = 0;
+}
+
+void* StreamBuffer::map(size_t bytes, size_t& offset) {
+    if (!vbo) initGL(bytes);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    if (bytes * framesInFlight > capacityBytes) {
+        // 单帧数据变多：至少翻倍重新分配，避免粒子逐渐增多时频繁扩容（旧存储由驱动在 GPU 用完后释放）
+        capacityBytes = (std::max)(bytes * framesInFlight, capacityBytes * 2);
+        glBufferData(GL_ARRAY_BUFFER, capacityBytes, nullptr, GL_STREAM_DRAW);
+        std::cout << "[StreamBuffer] Grown to " << capacityBytes / 1024 << " KB" << std::endl;
+        head = 0;
+    }
+    else if (head + bytes > capacityBytes) {
+        // 环形缓冲写满：孤立整块存储后从头开始
+        access |= GL_MAP_INVALIDATE_BUFFER_BIT;
+        head = 0;
+    }
+    else {
+        access |= GL_MAP_INVALIDATE_RANGE_BIT;
+    }
+
+    void* ptr = glMapBufferRange(GL_ARRAY_BUFFER, head, bytes, access);
+    if (!ptr) {
+        std::cerr << "[StreamBuffer] glMapBufferRange failed" << std::endl;
+        return nullptr;
+    }
+    mappedOffset = head;
+    offset = head;
+    return ptr;
+}
+
+bool StreamBuffer::unmap(size_t bytesWritten) {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    bool ok = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+
+    // 下一帧紧接在本帧实际写入的数据之后（映射但未写入的部分没有被绘制，可以直接复用）
+    head = (mappedOffset + bytesWritten + 63) & ~size_t(63);
+    return ok;
+}
+
+void StreamBuffer::cleanupGL() {
+    if (!vbo) return;
+
+    glDeleteBuffers(1, &vbo);
+    vbo = 0;
+    capacityBytes = 0;
+    head = 0;
+    mappedOffset = 0;
+}
@@ -266,6 +266,10 @@ void UIManager::CreateDefaultUI() {
         "F: Focus center",
         "9: Cinematic mode",
         "0: Auto test mode",
+        "P: Play show",
+        "B: Points / billboards",
+        "G: CPU / GPU simulation",
+        "N: Analytic bursts",
         "H: Hide/Show all UI hints",
         "ESC: Exit"
     };
@@ -601,6 +605,9 @@ void UIManager::SetFPS(float fps) {
     TextElement* element = GetTextElement("fps");
     if (element) {
         std::string text = "FPS: " + std::to_string((int)fps);
+        if (qualityLevel > 0) {
+            text += "  Quality: " + std::to_string(qualityLevel) + "/" + std::to_string(qualityLevelCount - 1);
+        }
         element->SetText(text);
 
         // 根据FPS设置颜色
@@ -618,6 +625,14 @@ void UIManager::SetFPS(float fps) {
     }
 }
 
+void UIManager::SetQualityLevel(int level, int levelCount) {
+    if (level > qualityLevel) {
+        ShowHint("Quality reduced to level " + std::to_string(level), 2.0f);
+    }
+    qualityLevel = level;
+    qualityLevelCount = levelCount;
+}
+
 void UIManager::SetMouseEnabled(bool enabled) {
     TextElement* element = GetTextElement("mouse_state");
     if (element) {
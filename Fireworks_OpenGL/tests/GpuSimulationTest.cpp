@@ -0,0 +1,298 @@
+﻿// GpuSimulationTest - 变换反馈 GPU 粒子模拟的冒烟测试（隐藏窗口，只用离屏的变换反馈，不显示画面）
+// 1. 超出缓冲容量的一批粒子（环形覆盖）在 GPU 上推进若干步，回读后与同样公式的 CPU 参考结果比较；
+// 2. 推迟加入的粒子（spawn 的 delaySteps，一帧多个子步时较晚生成的粒子）只模拟加入之后的步数；
+// 3. 解析爆炸的 particle_analytic.vs（用变换反馈截取 gl_Position）按闭式解算出的位置与逐步积分一致。
+// 没有独立显卡的机器可用 Mesa llvmpipe（软件光栅化）运行。需从项目目录运行以加载 assets/shaders；
+// 全部通过时返回 0，否则打印不一致的粒子并返回 1
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "GpuParticleSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Particle = GpuParticleSystem::Particle;
+
+static const float DT = 0.18f / 60.0f; // 与 FireworkSimulation 默认的 fixedStep × timeScale 一致
+static const float GRAVITY = -5.5f;
+static const float DRAG = 0.993f;
+
+static int checks = 0;
+static int failures = 0;
+
+// 与 particle_update.vs 相同的一步
+static void stepReference(Particle& p) {
+    if (p.posLife.w <= 0.0f) return;
+    glm::vec3 vel(p.velMaxLife);
+    if (p.params.z != 0.0f) {
+        float angle = p.params.y + DT * p.params.z;
+        float radius = std::sqrt(vel.x * vel.x + vel.z * vel.z);
+        vel.x = radius * std::cos(angle);
+        vel.z = radius * std::sin(angle);
+        p.params.y = angle;
+    }
+    glm::vec3 pos = glm::vec3(p.posLife) + vel * DT;
+    vel.y += GRAVITY * DT;
+    vel *= DRAG;
+    float life = p.posLife.w - DT;
+    if (life <= 0.0f || pos.y < 0.0f) life = 0.0f;
+    p.posLife = glm::vec4(pos, life);
+    p.velMaxLife = glm::vec4(vel, p.velMaxLife.w);
+}
+
+static Particle makeParticle(int i) {
+    float angle = i * 0.37f;
+    float life = 0.05f + (i % 10) * 0.02f; // 部分粒子在测试过程中耗尽寿命
+    Particle p;
+    p.posLife = glm::vec4(0.0f, 10.0f, 0.0f, life);
+    p.velMaxLife = glm::vec4(std::cos(angle) * 3.0f, 2.0f + std::sin(angle), std::sin(angle) * 3.0f, life);
+    p.color = glm::vec4(1.0f);
+    p.params = glm::vec4(0.1f, angle, (i % 3 == 0) ? 3.0f : 0.0f, 0.0f);
+    return p;
+}
+
+static std::vector<Particle> readBack(const GpuParticleSystem& gpu, size_t count) {
+    std::vector<Particle> out(count);
+    glBindBuffer(GL_ARRAY_BUFFER, gpu.currentBuffer());
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Particle), out.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return out;
+}
+
+// GPU 的三角函数与 CPU 不逐位一致，按相对误差比较
+static bool close(const glm::vec4& a, const glm::vec4& b) {
+    for (int c = 0; c < 4; ++c) {
+        if (std::fabs(a[c] - b[c]) > 1e-4f * (std::max)(1.0f, std::fabs(b[c]))) return false;
+    }
+    return true;
+}
+
+static void expect(bool ok, const char* test, size_t slot, const Particle& gpu, const Particle& ref) {
+    checks++;
+    if (ok) return;
+    failures++;
+    std::printf("[Test] FAIL %s slot %zu: gpu pos/life (%g %g %g %g) reference (%g %g %g %g)\n", test, slot,
+        gpu.posLife.x, gpu.posLife.y, gpu.posLife.z, gpu.posLife.w, ref.posLife.x, ref.posLife.y, ref.posLife.z, ref.posLife.w);
+}
+
+// 64 个槽位先后加入两批各 40 个粒子：第二批写满槽位 40~63 后绕回覆盖槽位 0~15，
+// 槽位 16~39 仍是第一批（已多模拟 10 步）
+static void testRingBuffer() {
+    const size_t capacity = 64;
+    const int batch = 40;
+    GpuParticleSystem gpu(capacity);
+    std::vector<Particle> first, second;
+    for (int i = 0; i < batch; ++i) {
+        first.push_back(makeParticle(i));
+        gpu.spawn(first.back());
+    }
+    for (int step = 0; step < 10; ++step) {
+        gpu.simulate(DT, GRAVITY, DRAG);
+        for (Particle& p : first) stepReference(p);
+    }
+    for (int i = 0; i < batch; ++i) {
+        second.push_back(makeParticle(batch + i));
+        gpu.spawn(second.back());
+    }
+    for (int step = 0; step < 40; ++step) {
+        gpu.simulate(DT, GRAVITY, DRAG);
+        for (Particle& p : first) stepReference(p);
+        for (Particle& p : second) stepReference(p);
+    }
+
+    std::vector<Particle> out = readBack(gpu, capacity);
+    for (size_t k = 0; k < capacity; ++k) {
+        const Particle& ref = k < 16 ? second[24 + k] : (k < 40 ? first[k] : second[k - 40]);
+        expect(close(out[k].posLife, ref.posLife) && close(out[k].velMaxLife, ref.velMaxLife), "ring buffer", k, out[k], ref);
+    }
+    gpu.cleanupGL();
+}
+
+// 同一帧 3 个子步：第 0 / 1 / 2 个子步生成的粒子分别推进 3 / 2 / 1 步
+static void testDelayedSpawn() {
+    const int subSteps = 3;
+    GpuParticleSystem gpu(16);
+    std::vector<Particle> reference;
+    for (int delay = 0; delay < subSteps; ++delay) {
+        Particle p = makeParticle(delay + 1);
+        p.posLife.w = p.velMaxLife.w = 1.0f;
+        gpu.spawn(p, delay);
+        for (int step = delay; step < subSteps; ++step) stepReference(p);
+        reference.push_back(p);
+    }
+    for (int step = 0; step < subSteps; ++step) gpu.simulate(DT, GRAVITY, DRAG);
+
+    std::vector<Particle> out = readBack(gpu, reference.size());
+    checks++;
+    if (gpu.activeSlots() != reference.size()) {
+        failures++;
+        std::printf("[Test] FAIL delayed spawn: %zu active slots, expected %zu\n", gpu.activeSlots(), reference.size());
+    }
+    for (size_t k = 0; k < reference.size(); ++k) {
+        expect(close(out[k].posLife, reference[k].posLife), "delayed spawn", k, out[k], reference[k]);
+    }
+    gpu.cleanupGL();
+}
+
+// 与 AnalyticBurstSystem::Particle 相同的布局（particle_analytic.vs 的 4 个输入）
+struct AnalyticParticle {
+    glm::vec4 originBirth;
+    glm::vec4 velLife;
+    glm::vec4 color;
+    glm::vec4 params;
+};
+
+// 只有 particle_analytic.vs 的程序，链接前登记 gl_Position 为变换反馈变量（view / projection 设为单位矩阵即为世界坐标）
+static GLuint buildAnalyticCapture() {
+    std::ifstream file("assets/shaders/particle_analytic.vs");
+    std::stringstream stream;
+    stream << file.rdbuf();
+    std::string code = stream.str();
+    const char* source = code.c_str();
+
+    GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &source, NULL);
+    glCompileShader(vertex);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    const char* varyings[] = { "gl_Position" };
+    glTransformFeedbackVaryings(program, 1, varyings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+    glDeleteShader(vertex);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        std::printf("[Test] Failed to build assets/shaders/particle_analytic.vs (run from the project directory)\n");
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// 解析位置对比逐步积分：同一初始状态分别经 particle_analytic.vs（时间 = steps × DT）和 stepReference 推进 steps 步。
+// 离散积分每步先用步初的速度移动，比连续的闭式解约超前半步的位移，容差取一步的位移
+static void testAnalyticBursts() {
+    const int steps = 120;
+    GLuint program = buildAnalyticCapture();
+    checks++;
+    if (program == 0) {
+        failures++;
+        return;
+    }
+
+    // 第 0 个为螺旋粒子（水平速度方向匀速旋转），第 1 个为普通粒子
+    std::vector<AnalyticParticle> input;
+    std::vector<Particle> reference;
+    for (int i = 0; i < 2; ++i) {
+        Particle p = makeParticle(i == 0 ? 3 : 1);
+        p.posLife.w = p.velMaxLife.w = 5.0f;
+        input.push_back({ glm::vec4(glm::vec3(p.posLife), 0.0f), p.velMaxLife, p.color, glm::vec4(p.params.x, p.params.y, p.params.z, 0.0f) });
+        for (int step = 0; step < steps; ++step) stepReference(p);
+        reference.push_back(p);
+    }
+
+    GLuint vao, vbo, capture;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, input.size() * sizeof(AnalyticParticle), input.data(), GL_STATIC_DRAW);
+    for (int a = 0; a < 4; ++a) {
+        glEnableVertexAttribArray(a);
+        glVertexAttribPointer(a, 4, GL_FLOAT, GL_FALSE, sizeof(AnalyticParticle), (void*)(a * sizeof(glm::vec4)));
+    }
+    glGenBuffers(1, &capture);
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, capture);
+    glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, input.size() * sizeof(glm::vec4), NULL, GL_STATIC_READ);
+
+    // 与 FireworkParticleSystem::render 相同的换算：每步速度乘以 DRAG，等价的连续衰减率为 -ln(DRAG) / DT
+    const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, identity);
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, identity);
+    glUniform1f(glGetUniformLocation(program, "pointScale"), 1.0f);
+    glUniform1f(glGetUniformLocation(program, "time"), steps * DT);
+    glUniform1f(glGetUniformLocation(program, "gravity"), GRAVITY);
+    glUniform1f(glGetUniformLocation(program, "dragRate"), -std::log(DRAG) / DT);
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, capture);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, (GLsizei)input.size());
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    std::vector<glm::vec4> out(input.size());
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, capture);
+    glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, out.size() * sizeof(glm::vec4), out.data());
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+
+    for (size_t k = 0; k < out.size(); ++k) {
+        glm::vec3 expected(reference[k].posLife);
+        glm::vec3 v0(input[k].velLife);
+        float tolerance = std::sqrt(glm::dot(v0, v0)) * DT;
+        glm::vec3 diff = glm::vec3(out[k]) - expected;
+        checks++;
+        if (std::sqrt(glm::dot(diff, diff)) > tolerance) {
+            failures++;
+            std::printf("[Test] FAIL analytic %s: shader (%g %g %g) stepped (%g %g %g)\n", k == 0 ? "spiral" : "burst",
+                out[k].x, out[k].y, out[k].z, expected.x, expected.y, expected.z);
+        }
+    }
+
+    glUseProgram(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDeleteBuffers(1, &capture);
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteProgram(program);
+}
+
+int main() {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "GpuSimulationTest", NULL, NULL);
+    if (window == NULL) {
+        std::printf("[Test] Failed to create an OpenGL 3.3 context\n");
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::printf("[Test] Failed to load OpenGL functions\n");
+        glfwTerminate();
+        return 1;
+    }
+    std::printf("[Test] GpuParticleSystem on %s\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+    testRingBuffer();
+    testDelayedSpawn();
+    testAnalyticBursts();
+
+    GLenum error = glGetError();
+    checks++;
+    if (error != GL_NO_ERROR) {
+        failures++;
+        std::printf("[Test] FAIL OpenGL error 0x%x\n", error);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    if (failures > 0) {
+        std::printf("[Test] GpuParticleSystem: %d of %d checks failed\n", failures, checks);
+        return 1;
+    }
+    std::printf("[Test] GpuParticleSystem: all %d checks passed\n", checks);
+    return 0;
+}
@@ -0,0 +1,114 @@
+﻿// KernelTests - 粒子内核的逐位一致性测试（无 OpenGL / GLFW / 音频依赖，只链接 FireworksSim）
+// 同一份随机 SoA 数据分别交给标量、SSE2、AVX2 版本（只测当前 CPU 支持的级别），逐字节比较全部输出；
+// 粒子数覆盖 0、不足一个向量、非向量宽度整数倍和整块等情况，让向量循环和标量收尾都被执行到。
+// 全部通过时返回 0，否则打印不一致的内核并返回 1
+#include "ParticleKernels.h"
+#include "FastRandom.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+using ParticleKernels::Level;
+
+static int checks = 0;
+static int failures = 0;
+
+static void expect(bool ok, const char* kernel, Level level, int count) {
+    checks++;
+    if (ok) return;
+    failures++;
+    std::printf("[Test] FAIL %s: %s differs from Scalar (count=%d)\n", kernel, ParticleKernels::levelName(level), count);
+}
+
+static bool sameBits(const float* a, const float* b, int count) {
+    return std::memcmp(a, b, sizeof(float) * count) == 0;
+}
+
+// 随机填充一个块：包含已死亡的粒子、本步就会耗尽寿命的粒子和即将落到地面以下的粒子
+static void fillChunk(ParticleChunk& c, int count, FastRandom& rng) {
+    c.reset(0);
+    for (int i = 0; i < count; ++i) {
+        glm::vec3 position(rng.uniform(-10.0f, 10.0f), rng.uniform(-0.01f, 20.0f), rng.uniform(-10.0f, 10.0f));
+        glm::vec3 velocity(rng.uniform(-8.0f, 8.0f), rng.uniform(-8.0f, 8.0f), rng.uniform(-8.0f, 8.0f));
+        c.push(position, velocity, glm::vec4(1.0f), rng.uniform(0.001f, 0.6f), 0.3f, 0.0f);
+        if (rng.uniform() < 0.1f) c.kill(i);
+    }
+    for (int s = 0; s < TrailRing::SAMPLES; ++s) {
+        for (int i = 0; i < count; ++i) {
+            c.trailX[s][i] = c.posX[i] + rng.uniform(-1.0f, 1.0f);
+            c.trailY[s][i] = c.posY[i] + rng.uniform(-1.0f, 1.0f);
+            c.trailZ[s][i] = c.posZ[i] + rng.uniform(-1.0f, 1.0f);
+        }
+    }
+}
+
+// 比较一步积分后的状态；prev 只比较积分前存活的粒子（向量版本会写死亡粒子的 prev，这些值不会被读取）
+static bool sameState(const ParticleChunk& a, const ParticleChunk& b, const float* lifeBefore) {
+    int n = a.count;
+    bool same = a.count == b.count && a.aliveCount == b.aliveCount &&
+        sameBits(a.posX, b.posX, n) && sameBits(a.posY, b.posY, n) && sameBits(a.posZ, b.posZ, n) &&
+        sameBits(a.velX, b.velX, n) && sameBits(a.velY, b.velY, n) && sameBits(a.velZ, b.velZ, n) &&
+        sameBits(a.life, b.life, n);
+    for (int i = 0; i < n && same; ++i) {
+        if (lifeBefore[i] <= 0.0f) continue;
+        same = sameBits(&a.prevX[i], &b.prevX[i], 1) && sameBits(&a.prevY[i], &b.prevY[i], 1) && sameBits(&a.prevZ[i], &b.prevZ[i], 1);
+    }
+    return same;
+}
+
+int main() {
+    const Level best = ParticleKernels::bestLevel();
+    std::printf("[Test] ParticleKernels: best level %s\n", ParticleKernels::levelName(best));
+    if (best == Level::Scalar) std::printf("[Test] No SIMD kernels on this CPU, nothing to compare\n");
+
+    static const int counts[] = { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 100, 255, ParticleChunk::CAPACITY };
+    const float dt = 0.003f;
+    const float gravityStep = -5.5f * dt;
+    const float drag = 0.9993f;
+
+    // 块约 35 KB，放在堆上
+    auto source = std::make_unique<ParticleChunk>();
+    auto reference = std::make_unique<ParticleChunk>();
+    auto candidate = std::make_unique<ParticleChunk>();
+    alignas(32) static float referenceAge[ParticleChunk::CAPACITY];
+    alignas(32) static float candidateAge[ParticleChunk::CAPACITY];
+    static float lifeBefore[ParticleChunk::CAPACITY];
+
+    FastRandom rng(20240101);
+    for (int count : counts) {
+        fillChunk(*source, count, rng);
+
+        for (int l = static_cast<int>(Level::SSE2); l <= static_cast<int>(best); ++l) {
+            Level level = static_cast<Level>(l);
+
+            // 多步积分：死亡标记和 aliveCount 也要一致
+            *reference = *source;
+            *candidate = *source;
+            bool same = true;
+            for (int step = 0; step < 40 && same; ++step) {
+                std::memcpy(lifeBefore, reference->life, sizeof(float) * count);
+                ParticleKernels::integrate(Level::Scalar, *reference, dt, gravityStep, drag);
+                ParticleKernels::integrate(level, *candidate, dt, gravityStep, drag);
+                same = sameState(*reference, *candidate, lifeBefore);
+            }
+            expect(same, "integrate", level, count);
+
+            ParticleKernels::normalizedAge(Level::Scalar, reference->life, reference->maxLife, referenceAge, count);
+            ParticleKernels::normalizedAge(level, reference->life, reference->maxLife, candidateAge, count);
+            expect(sameBits(referenceAge, candidateAge, count), "normalizedAge", level, count);
+
+            for (int slot = 0; slot < TrailRing::SAMPLES; ++slot) {
+                float a = ParticleKernels::maxTrailMoveSq(Level::Scalar, *source, slot);
+                float b = ParticleKernels::maxTrailMoveSq(level, *source, slot);
+                expect(std::memcmp(&a, &b, sizeof(float)) == 0, "maxTrailMoveSq", level, count);
+            }
+        }
+    }
+
+    if (failures > 0) {
+        std::printf("[Test] ParticleKernels: %d of %d checks failed\n", failures, checks);
+        return 1;
+    }
+    std::printf("[Test] ParticleKernels: all %d checks passed\n", checks);
+    return 0;
+}